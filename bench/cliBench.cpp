@@ -0,0 +1,288 @@
+/*
+ * cliBench.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ *
+ *  Microbenchmarks of the CLI engine hot paths: tokenizer, dispatch,
+ *  TAB completion and context help, against synthetic registries of
+ *  100, 1k and 10k commands. Built with Google Benchmark and linked with
+ *  readlineStub.c instead of libreadline by the Makefile of this directory.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <readline/readline.h>
+
+#include "cliApi.h"
+#include "cliCommand.h"
+#include "cliCommandIndex.h"
+#include "cliHistory.h"
+#include "cliSession.h"
+#include "cliTokenizer.h"
+
+#include "cliSynthetic.h"
+
+using namespace CLI;
+
+namespace {
+
+	typedef boost::shared_ptr<SyntheticCommand> SyntheticPtr_t;
+
+	struct Registry
+	{
+		explicit Registry(size_t size)
+		{
+			for (size_t id = 0; id < size; ++id)
+			{
+				SyntheticPtr_t command(new SyntheticCommand(id));
+
+				commands.push_back(command);
+				index.insert(command);
+
+				BasicStringContainer_t line(command->keywords());
+				line.push_back("42");
+				lines.push_back(line);
+			}
+		}
+
+		std::vector<SyntheticPtr_t>         commands;
+		std::vector<BasicStringContainer_t> lines;
+		CommandIndex                        index;
+	};
+
+	Registry& registry(size_t size)
+	{
+		static std::map<size_t, boost::shared_ptr<Registry> > registries;
+
+		boost::shared_ptr<Registry>& result = registries[size];
+		if (!result)
+			result.reset(new Registry(size));
+
+		return *result;
+	}
+
+	/* Dispatch as the engine did before the index: validate every command */
+	bool linearLookup(Registry& reg, const BasicStringContainer_t& tokens, ParameterStorageType_t& params)
+	{
+		for (size_t i = 0; i < reg.commands.size(); ++i)
+		{
+			CommandError_t error;
+			error.position = tokens.begin();
+
+			if (reg.commands[i]->validate(tokens, params, error))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool indexLookup(Registry& reg, const BasicStringContainer_t& tokens, ParameterStorageType_t& params)
+	{
+		CommandIndex::Match match;
+		reg.index.match(tokens, tokens.size(), match);
+
+		const CommandIndex::CandidateContainer_t& candidates = match.commands();
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			CommandError_t error;
+			error.position = tokens.begin();
+
+			if (candidates[i]->command->validate(tokens, params, error))
+				return true;
+		}
+
+		return false;
+	}
+
+	/*
+	 * Registry also known to the engine. The engine registry only grows,
+	 * so the engine benchmarks all use the same size. History goes to a
+	 * directory of its own instead of the user's.
+	 */
+	Registry& engineRegistry(size_t size)
+	{
+		static size_t registered = 0;
+
+		Registry& reg = registry(size);
+
+		if (registered == 0)
+		{
+			char directory[] = "/tmp/cli-bench-XXXXXX";
+			if (::mkdtemp(directory) != NULL)
+				setHistoryDirectory(directory);
+
+			ModulePtr_t module = createModule("bench", "synthetic commands", CLI_CTX_NORMAL);
+
+			for (size_t i = 0; i < reg.commands.size(); ++i)
+				registerCommand(module, reg.commands[i], allowAll, CLI_CTX_NORMAL);
+
+			registered = size;
+		}
+
+		assert(registered == size);
+		return reg;
+	}
+
+	/* Engine output is written, but not to the terminal */
+	int nullDevice()
+	{
+		static int fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+		return fd;
+	}
+
+	void freeMatches(char** matches)
+	{
+		if (matches == NULL)
+			return;
+
+		for (char** It = matches; *It != NULL; ++It)
+			free(*It);
+
+		free(matches);
+	}
+
+	std::string lineOfLength(size_t length)
+	{
+		std::string line;
+
+		while (line.size() < length)
+			line += "show interface \"gigabit ethernet 1/0/1\" counters   detail ";
+
+		line.resize(length);
+		return line;
+	}
+
+} // namespace
+
+static void BM_Tokenize(benchmark::State& state)
+{
+	std::string line = lineOfLength(state.range(0));
+	Tokenizer tokenizer;
+	BasicStringContainer_t tokens;
+
+	for (auto _ : state)
+	{
+		tokenizer.split(line);
+		tokenizer.assign(tokens);
+		benchmark::DoNotOptimize(tokens.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * line.size());
+}
+BENCHMARK(BM_Tokenize)->Arg(16)->Arg(64)->Arg(256)->Arg(4096);
+
+static void BM_DispatchLinear(benchmark::State& state)
+{
+	Registry& reg = registry(state.range(0));
+	ParameterStorageType_t params;
+	size_t next = 0;
+
+	for (auto _ : state)
+	{
+		const BasicStringContainer_t& line = reg.lines[next++ % reg.lines.size()];
+		benchmark::DoNotOptimize(linearLookup(reg, line, params));
+	}
+}
+BENCHMARK(BM_DispatchLinear)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_Dispatch(benchmark::State& state)
+{
+	Registry& reg = registry(state.range(0));
+	ParameterStorageType_t params;
+	size_t next = 0;
+
+	for (auto _ : state)
+	{
+		const BasicStringContainer_t& line = reg.lines[next++ % reg.lines.size()];
+		benchmark::DoNotOptimize(indexLookup(reg, line, params));
+	}
+}
+BENCHMARK(BM_Dispatch)->Arg(100)->Arg(1000)->Arg(10000);
+
+/*
+ * TAB after the second keyword with one letter typed, through the
+ * completion function the engine installs into readline
+ */
+static void BM_Completion(benchmark::State& state)
+{
+	Registry& reg = engineRegistry(state.range(0));
+	std::vector<std::string> lines;
+
+	for (size_t i = 0; i < reg.lines.size(); ++i)
+		lines.push_back(reg.lines[i][0] + " " + reg.lines[i][1] + " " + reg.lines[i][2][0]);
+
+	size_t next = 0;
+
+	for (auto _ : state)
+	{
+		std::string& line = lines[next++ % lines.size()];
+		int end = line.size();
+
+		rl_line_buffer = &line[0];
+		char** matches = rl_attempted_completion_function(&line[end - 1], end - 1, end);
+
+		benchmark::DoNotOptimize(matches);
+		freeMatches(matches);
+	}
+}
+BENCHMARK(BM_Completion)->Arg(10000);
+
+/* "show interface ?" through executeLine, so HelpCache is part of it */
+static void BM_ContextHelp(benchmark::State& state)
+{
+	Registry& reg = engineRegistry(state.range(0));
+	Session session;
+	std::vector<std::string> lines;
+
+	session.output.setDescriptor(nullDevice());
+
+	for (size_t i = 0; i < reg.lines.size(); ++i)
+		lines.push_back(reg.lines[i][0] + " " + reg.lines[i][1] + " ?");
+
+	size_t next = 0;
+
+	for (auto _ : state)
+	{
+		executeLine(session, lines[next++ % lines.size()]);
+		session.output.flush();
+	}
+}
+BENCHMARK(BM_ContextHelp)->Arg(10000);
+
+/*
+ * Whole engine path of a line: tokenizer, snapshot, dispatch, locking and
+ * execute, on a session which is not the console
+ */
+static void BM_ExecuteLine(benchmark::State& state)
+{
+	Registry& reg = engineRegistry(state.range(0));
+	Session session;
+	std::vector<std::string> lines;
+
+	session.output.setDescriptor(nullDevice());
+
+	for (size_t i = 0; i < reg.lines.size(); ++i)
+	{
+		std::string text;
+		for (size_t j = 0; j < reg.lines[i].size(); ++j)
+			text += reg.lines[i][j] + " ";
+		lines.push_back(text);
+	}
+
+	size_t next = 0;
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(executeLine(session, lines[next++ % lines.size()]));
+}
+BENCHMARK(BM_ExecuteLine)->Arg(10000);
+
+BENCHMARK_MAIN();
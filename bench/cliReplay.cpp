@@ -0,0 +1,98 @@
+/*
+ * cliReplay.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ *
+ *  Load generator replaying recorded operator sessions (see
+ *  startRecording) against the engine without readline, and reporting
+ *  throughput and latency percentiles. The commands are the synthetic
+ *  set of the benchmark; linked with the product modules instead, the
+ *  real command set is load tested. Built like the benchmark, see the
+ *  Makefile of this directory.
+ *
+ *  Usage: cliReplay [-s speed] [-c copies] [-n commands] recording
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <iostream>
+
+#include "cliApi.h"
+#include "cliCommand.h"
+#include "cliRecorder.h"
+#include "cliSession.h"
+
+#include "cliSynthetic.h"
+
+using namespace CLI;
+
+namespace {
+
+	const size_t DEFAULT_COMMANDS = 10000;
+
+	void usage(const char* name)
+	{
+		std::cerr << "Usage: " << name << " [-s speed] [-c copies] [-n commands] recording\n"
+			<< "  -s  pace of the recording, 0 runs the lines back to back (1)\n"
+			<< "  -c  simulated sessions per recorded one, entering each line in turn (1)\n"
+			<< "  -n  synthetic commands to register (" << DEFAULT_COMMANDS << ")\n";
+	}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	ReplayOptions options;
+	size_t commands = DEFAULT_COMMANDS;
+	int option;
+
+	while ((option = getopt(argc, argv, "s:c:n:")) != -1)
+	{
+		switch (option)
+		{
+		case 's': options.speed = atof(optarg); break;
+		case 'c': options.copies = atoi(optarg); break;
+		case 'n': commands = atoi(optarg); break;
+		default:
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (optind + 1 != argc || options.copies == 0 || options.speed < 0)
+	{
+		usage(argv[0]);
+		return 2;
+	}
+
+	ModulePtr_t module = createModule("replay", "synthetic commands", CLI_CTX_NORMAL);
+
+	for (size_t id = 0; id < commands; ++id)
+		registerCommand(module, CommandPtr_t(new SyntheticCommand(id)), allowAll, CLI_CTX_NORMAL);
+
+	// commands printing to stdout must not mix with the report
+	int saved = dup(STDOUT_FILENO);
+	int null = open("/dev/null", O_WRONLY);
+	dup2(null, STDOUT_FILENO);
+	close(null);
+
+	ReplayReport report;
+	bool replayed = replayRecording(argv[optind], options, report);
+
+	fflush(stdout);
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+
+	if (!replayed)
+	{
+		std::cerr << argv[optind] << ": can not read the recording\n";
+		return 1;
+	}
+
+	printReplayReport(report, std::cout);
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * cliSynthetic.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ *
+ *  Synthetic command set shared by the benchmark and the replay tool.
+ */
+
+#ifndef CLISYNTHETIC_H_
+#define CLISYNTHETIC_H_
+
+#include <string.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "cliApi.h"
+#include "cliCommand.h"
+
+namespace CLI {
+
+namespace {
+
+	const char* VERBS[] = { "show", "clear", "set", "no", "debug" };
+	const char* OBJECTS[] = { "interface", "vlan", "port", "counters", "route",
+			"arp", "mac", "lldp", "snmp", "ntp", "user", "log", "qos", "acl", "stp", "igmp" };
+
+	const size_t VERB_COUNT = sizeof(VERBS) / sizeof(VERBS[0]);
+	const size_t OBJECT_COUNT = sizeof(OBJECTS) / sizeof(OBJECTS[0]);
+
+	/*
+	 * "<verb> <object> item<N> [detail<M>] <value>", keyword paths three
+	 * or four words deep as in the real command set
+	 */
+	class SyntheticCommand : public Command
+	{
+		public:
+			explicit SyntheticCommand(size_t id)
+			{
+				keywords_.push_back(VERBS[id % VERB_COUNT]);
+				keywords_.push_back(OBJECTS[(id / VERB_COUNT) % OBJECT_COUNT]);
+
+				std::ostringstream item;
+				item << "item" << id / (VERB_COUNT * OBJECT_COUNT);
+				keywords_.push_back(item.str());
+
+				if (id % 2)
+				{
+					std::ostringstream detail;
+					detail << "detail" << id % 7;
+					keywords_.push_back(detail.str());
+				}
+			}
+
+			const BasicStringContainer_t& keywords() const { return keywords_; }
+
+			bool validate(const std::vector<std::string>& tokens, ParameterStorageType_t& params, CommandError_t& error)
+			{
+				size_t matched = matchKeywords(tokens);
+
+				if (matched < keywords_.size())
+				{
+					error.error = matched == tokens.size() ? CLI_CMD_SHORT : CLI_CMD_WRONG_KEYWORD;
+					error.position = tokens.begin() + matched;
+					return false;
+				}
+
+				if (tokens.size() != keywords_.size() + 1)
+				{
+					error.error = tokens.size() > keywords_.size() + 1 ? CLI_CMD_TOO_LONG : CLI_CMD_SHORT;
+					error.position = tokens.begin() + std::min(tokens.size(), keywords_.size() + 1);
+					return false;
+				}
+
+				params["value"] = tokens.back();
+				return true;
+			}
+
+			void getContextHelp(const std::vector<std::string>& tokens, std::vector<std::string>& help)
+			{
+				size_t matched = matchKeywords(tokens);
+
+				if (matched != tokens.size())
+					return;
+
+				if (matched < keywords_.size())
+					help.push_back(keywords_[matched] + "    synthetic keyword");
+				else if (matched == keywords_.size())
+					help.push_back("<value>    synthetic value");
+			}
+
+			char* completion(bool /* get */, const std::vector<std::string>& tokens, int& startWithIndex)
+			{
+				if (tokens.size() < keywords_.size() || matchKeywords(tokens) < keywords_.size())
+					return NULL;
+
+				startWithIndex = 0;
+				return strdup("value");
+			}
+
+			void execute(const ParameterStorageType_t& /* params */, const std::string& /* group */)
+			{
+			}
+
+		private:
+			size_t matchKeywords(const std::vector<std::string>& tokens) const
+			{
+				size_t i = 0;
+				for (; i < keywords_.size() && i < tokens.size(); ++i)
+				{
+					if (keywords_[i].compare(0, tokens[i].size(), tokens[i]) != 0)
+						break;
+				}
+
+				return i;
+			}
+
+			BasicStringContainer_t keywords_;
+	};
+
+	bool allowAll(const std::string& /* group */)
+	{
+		return true;
+	}
+
+} // namespace
+
+} // CLI
+
+#endif /* CLISYNTHETIC_H_ */
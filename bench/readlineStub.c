@@ -0,0 +1,117 @@
+/*
+ * readlineStub.c
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ *
+ *  Headless replacement of the readline symbols used by the CLI engine,
+ *  linked into the benchmarks instead of libreadline so they run in CI
+ *  without a terminal.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <readline/readline.h>
+#include <readline/history.h>
+
+char* rl_line_buffer = "";
+int rl_done = 0;
+int rl_attempted_completion_over = 0;
+int rl_point = 0;
+int rl_end = 0;
+rl_hook_func_t* rl_pre_input_hook = NULL;
+rl_completion_func_t* rl_attempted_completion_function = NULL;
+
+char* readline(const char* prompt)
+{
+	(void)prompt;
+	return NULL;
+}
+
+void using_history(void)
+{
+}
+
+void clear_history(void)
+{
+}
+
+void add_history(const char* line)
+{
+	(void)line;
+}
+
+int rl_bind_key(int key, rl_command_func_t* function)
+{
+	(void)key;
+	(void)function;
+	return 0;
+}
+
+int rl_variable_bind(const char* variable, const char* value)
+{
+	(void)variable;
+	(void)value;
+	return 0;
+}
+
+int rl_insert_text(const char* text)
+{
+	(void)text;
+	return 0;
+}
+
+void rl_redisplay(void)
+{
+}
+
+void rl_replace_line(const char* text, int clear_undo)
+{
+	(void)text;
+	(void)clear_undo;
+}
+
+int rl_ding(void)
+{
+	return 0;
+}
+
+int rl_reverse_search_history(int count, int key)
+{
+	(void)count;
+	(void)key;
+	return 0;
+}
+
+/* Like readline: the text itself first, then the matches, NULL if there are none */
+char** rl_completion_matches(const char* text, rl_compentry_func_t* generator)
+{
+	size_t count = 1;
+	char** matches = NULL;
+	char* match;
+
+	while ((match = generator(text, count - 1)) != NULL)
+	{
+		matches = (char**)realloc(matches, (count + 2) * sizeof(char*));
+		matches[count++] = match;
+	}
+
+	if (matches == NULL)
+		return NULL;
+
+	matches[0] = strdup(text);
+	matches[count] = NULL;
+
+	return matches;
+}
+
+HISTORY_STATE* history_get_history_state(void)
+{
+	return (HISTORY_STATE*)calloc(1, sizeof(HISTORY_STATE));
+}
+
+void history_set_history_state(HISTORY_STATE* state)
+{
+	(void)state;
+}
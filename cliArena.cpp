@@ -0,0 +1,93 @@
+/*
+ * cliArena.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <algorithm>
+
+#include "cliArena.h"
+
+namespace CLI {
+
+Arena::Arena(size_t blockSize) :
+	blockSize_(blockSize), blocks_(NULL), position_(NULL), end_(NULL)
+{
+}
+
+Arena::Arena(const Arena& other) :
+	blockSize_(other.blockSize_), blocks_(NULL), position_(NULL), end_(NULL)
+{
+}
+
+Arena& Arena::operator=(const Arena& /* other */)
+{
+	return *this;
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+char* Arena::begin(Block* block) const
+{
+	return reinterpret_cast<char*>(block) + sizeof(Block);
+}
+
+void* Arena::grow(size_t size, size_t alignment)
+{
+	size_t capacity = std::max<size_t>(blockSize_, size + alignment);
+
+	if (blocks_ != NULL)
+		capacity = std::max(capacity, 2 * blocks_->size);
+
+	Block* block = static_cast<Block*>(::operator new(sizeof(Block) + capacity));
+	block->next = blocks_;
+	block->size = capacity;
+
+	blocks_ = block;
+	position_ = begin(block);
+	end_ = position_ + capacity;
+
+	return allocate(size, alignment);
+}
+
+void Arena::reset()
+{
+	// a line which needed several blocks gets them as one from now on
+	if (blocks_ != NULL && blocks_->next != NULL)
+	{
+		size_t total = 0;
+		for (Block* block = blocks_; block != NULL; block = block->next)
+			total += block->size;
+
+		release();
+
+		blocks_ = static_cast<Block*>(::operator new(sizeof(Block) + total));
+		blocks_->next = NULL;
+		blocks_->size = total;
+	}
+
+	if (blocks_ != NULL)
+	{
+		position_ = begin(blocks_);
+		end_ = position_ + blocks_->size;
+	}
+}
+
+void Arena::release()
+{
+	while (blocks_ != NULL)
+	{
+		Block* next = blocks_->next;
+		::operator delete(blocks_);
+		blocks_ = next;
+	}
+
+	position_ = NULL;
+	end_ = NULL;
+}
+
+} // CLI
@@ -0,0 +1,157 @@
+/*
+ * cliArena.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIARENA_H_
+#define CLIARENA_H_
+
+#include <stddef.h>
+#include <new>
+
+#include <boost/type_traits/alignment_of.hpp>
+
+namespace CLI {
+
+	/*
+	 * Monotonic memory for the temporaries of one command line. Memory is
+	 * handed out by moving a pointer and is never freed one by one; reset()
+	 * makes all of it available again once the line is done. After a few
+	 * lines the arena has grown to fit and stops allocating.
+	 */
+	class Arena
+	{
+		public:
+			enum { DEFAULT_BLOCK_SIZE = 16 * 1024 };
+
+			explicit Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+			~Arena();
+
+			/* A copy starts empty, memory is never shared */
+			Arena(const Arena& other);
+			Arena& operator=(const Arena& other);
+
+			void* allocate(size_t size, size_t alignment)
+			{
+				char* result = align(position_, alignment);
+
+				if (result > end_ || size > static_cast<size_t>(end_ - result))
+					return grow(size, alignment);
+
+				position_ = result + size;
+				return result;
+			}
+
+			/* Forgets every allocation, keeps the memory */
+			void reset();
+
+			/* Resets the arena when the line is done */
+			class Scope
+			{
+				public:
+					explicit Scope(Arena& arena) : arena_(arena) {}
+					~Scope() { arena_.reset(); }
+
+				private:
+					Scope(const Scope&);
+					Scope& operator=(const Scope&);
+
+					Arena& arena_;
+			};
+
+		private:
+			struct Block
+			{
+				Block* next;
+				size_t size;
+			};
+
+			static char* align(char* position, size_t alignment)
+			{
+				size_t address = reinterpret_cast<size_t>(position);
+				return position + ((alignment - address % alignment) % alignment);
+			}
+
+			void* grow(size_t size, size_t alignment);
+			char* begin(Block* block) const;
+			void release();
+
+			const size_t blockSize_;
+			Block*       blocks_;     // newest first
+			char*        position_;
+			char*        end_;
+	};
+
+	/*
+	 * Standard allocator on an arena. Without an arena it falls back to
+	 * the heap, so containers using it work anywhere.
+	 */
+	template <class T>
+	class ArenaAllocator
+	{
+		public:
+			typedef T              value_type;
+			typedef T*             pointer;
+			typedef const T*       const_pointer;
+			typedef T&             reference;
+			typedef const T&       const_reference;
+			typedef size_t         size_type;
+			typedef ptrdiff_t      difference_type;
+
+			template <class U>
+			struct rebind
+			{
+				typedef ArenaAllocator<U> other;
+			};
+
+			ArenaAllocator() : arena_(NULL) {}
+			explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+
+			template <class U>
+			ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+			Arena* arena() const { return arena_; }
+
+			pointer allocate(size_type count, const void* /* hint */ = 0)
+			{
+				if (arena_ == NULL)
+					return static_cast<pointer>(::operator new(count * sizeof(T)));
+
+				return static_cast<pointer>(arena_->allocate(count * sizeof(T), boost::alignment_of<T>::value));
+			}
+
+			void deallocate(pointer p, size_type /* count */)
+			{
+				if (arena_ == NULL)
+					::operator delete(p);
+			}
+
+			void construct(pointer p, const T& value) { new (p) T(value); }
+			void destroy(pointer p) { p->~T(); }
+
+			pointer address(reference value) const { return &value; }
+			const_pointer address(const_reference value) const { return &value; }
+
+			size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+		private:
+			Arena* arena_;
+	};
+
+	template <class T, class U>
+	bool operator==(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right)
+	{
+		return left.arena() == right.arena();
+	}
+
+	template <class T, class U>
+	bool operator!=(const ArenaAllocator<T>& left, const ArenaAllocator<U>& right)
+	{
+		return left.arena() != right.arena();
+	}
+
+} // CLI
+
+#endif /* CLIARENA_H_ */
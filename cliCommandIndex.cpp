@@ -0,0 +1,472 @@
+/*
+ * cliCommandIndex.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <algorithm>
+#include <stdlib.h>
+
+#include "cliCommandIndex.h"
+
+using namespace std;
+
+namespace CLI {
+
+namespace {
+
+	/* Deepest keyword path probed per command */
+	const size_t MAX_KEYWORD_DEPTH = 8;
+
+	/* Guard against a provider which never resets its index */
+	const size_t MAX_PROVIDED_VALUES = 4096;
+
+	/* Edits allowed between a mistyped token and a suggested keyword */
+	unsigned suggestionDistance (const std::string& token)
+	{
+		return token.size() < 4 ? 1 : 2;
+	}
+
+	bool isKeyword (const std::string& word)
+	{
+		if (word.empty())
+			return false;
+
+		switch (word[0])
+		{
+		case '<':
+		case '[':
+		case '{':
+		case '(':
+		case '|':
+			return false;
+		default:
+			return true;
+		}
+	}
+
+	/* First word of a help line, help lines look like "keyword   description" */
+	std::string firstWord (const std::string& line)
+	{
+		std::string::size_type begin = line.find_first_not_of(" \t");
+
+		if (begin == std::string::npos)
+			return std::string();
+
+		std::string::size_type end = line.find_first_of(" \t", begin);
+
+		return line.substr(begin, end == std::string::npos ? end : end - begin);
+	}
+
+	bool startsWith (const std::string& str, const std::string& prefix)
+	{
+		return str.compare(0, prefix.size(), prefix) == 0;
+	}
+
+	struct EntryOrder
+	{
+		template <class T>
+		bool operator()(const T& lhs, const T& rhs) const
+		{
+			return lhs.order < rhs.order;
+		}
+	};
+
+} // namespace
+
+CommandIndex::CommandIndex() :
+	root_(new Node), size_(0)
+{
+}
+
+void CommandIndex::clear()
+{
+	root_.reset(new Node);
+	size_ = 0;
+}
+
+void CommandIndex::keywordPath(const CommandPtr_t& command, BasicStringContainer_t& path,
+		HelpLevelContainer_t* levels)
+{
+	BasicStringContainer_t help;
+
+	path.clear();
+
+	if (levels != NULL)
+		levels->clear();
+
+	while (path.size() < MAX_KEYWORD_DEPTH)
+	{
+		help.clear();
+		command->getContextHelp(path, help);
+
+		if (levels != NULL)
+			levels->push_back(help);
+
+		// only a single fixed continuation is a keyword,
+		// alternatives and parameters are left to validate()
+		if (help.size() != 1)
+			break;
+
+		std::string word = firstWord(help.front());
+
+		if (!isKeyword(word))
+			break;
+
+		path.push_back(word);
+	}
+}
+
+void CommandIndex::insert(const CommandInfoPtr_t& info)
+{
+	BasicStringContainer_t path;
+	keywordPath(info->command, path);
+
+	GroupMask_t groups = info->groups.load();
+
+	// copy the nodes of the path in use by snapshots, they are left intact;
+	// a node only this index refers to is changed in place
+	if (!root_.unique())
+		root_.reset(new Node(*root_));
+
+	Node* node = root_.get();
+	node->groups.fetch_or(groups);
+
+	for (BasicStringContainer_t::const_iterator It = path.begin(); It != path.end(); ++It)
+	{
+		NodePtr_t& child = node->children[*It];
+
+		if (!child)
+		{
+			child.reset(new Node);
+			node->prefixes.set(*It, child.get());
+			node->keywords.insert(*It);
+		}
+		else if (!child.unique())
+		{
+			child.reset(new Node(*child));
+			node->prefixes.set(*It, child.get());
+		}
+
+		node = child.get();
+		node->groups.fetch_or(groups);
+	}
+
+	Entry entry;
+	entry.order = size_++;
+	entry.depth = path.size();
+	entry.info = info;
+
+	node->commands.push_back(entry);
+}
+
+/* Commands of the node allowed to the groups */
+void CommandIndex::append(const Node& node, GroupMask_t groups, EntryContainer_t& found)
+{
+	for (std::vector<Entry>::const_iterator It = node.commands.begin(); It != node.commands.end(); ++It)
+	{
+		if (It->info->groups.load(boost::memory_order_relaxed) & groups)
+			found.push_back(*It);
+	}
+}
+
+void CommandIndex::collect(const Node& node, GroupMask_t groups, EntryContainer_t& found)
+{
+	if (!(node.groups.load(boost::memory_order_relaxed) & groups))
+		return;
+
+	append(node, groups, found);
+
+	for (ChildrenType_t::const_iterator It = node.children.begin(); It != node.children.end(); ++It)
+		collect(*It->second, groups, found);
+}
+
+GroupMask_t CommandIndex::refreshGroups(const Node& node)
+{
+	GroupMask_t groups = 0;
+
+	for (std::vector<Entry>::const_iterator It = node.commands.begin(); It != node.commands.end(); ++It)
+		groups |= It->info->groups.load();
+
+	for (ChildrenType_t::const_iterator It = node.children.begin(); It != node.children.end(); ++It)
+		groups |= refreshGroups(*It->second);
+
+	node.groups.fetch_or(groups);
+
+	return groups;
+}
+
+void CommandIndex::refreshGroups() const
+{
+	refreshGroups(*root_);
+}
+
+void CommandIndex::sorted(EntryContainer_t& found, CandidateContainer_t& candidates,
+		DepthContainer_t* depths)
+{
+	std::sort(found.begin(), found.end(), EntryOrder());
+
+	candidates.clear();
+	candidates.reserve(found.size());
+
+	for (EntryContainer_t::const_iterator It = found.begin(); It != found.end(); ++It)
+		candidates.push_back(It->info);
+
+	if (depths == NULL)
+		return;
+
+	depths->clear();
+	depths->reserve(found.size());
+
+	for (EntryContainer_t::const_iterator It = found.begin(); It != found.end(); ++It)
+		depths->push_back(It->depth);
+}
+
+void CommandIndex::commands(CandidateContainer_t& all) const
+{
+	EntryContainer_t found;
+	found.reserve(size_);
+
+	collect(*root_, CLI_GROUPS_ALL, found);
+	sorted(found, all);
+}
+
+/* Selects the children of a node a token stands for */
+struct CommandIndex::Selection
+{
+	Selection(const PrefixTrie_t& prefixes, GroupMask_t groups, FrontierType_t& next,
+			const std::string*& keyword, bool& several) :
+		prefixes_(prefixes), groups_(groups), next_(next), keyword_(keyword), several_(several)
+	{}
+
+	void operator()(PrefixTrie_t::Index_t index)
+	{
+		const Node* child = prefixes_.value(index);
+
+		if (!(child->groups.load(boost::memory_order_relaxed) & groups_))
+			return;
+
+		next_.push_back(child);
+
+		const std::string& word = prefixes_.word(index);
+
+		if (keyword_ == NULL)
+			keyword_ = &word;
+		else if (*keyword_ != word)
+			several_ = true;
+	}
+
+	const PrefixTrie_t&  prefixes_;
+	GroupMask_t          groups_;
+	FrontierType_t&      next_;
+	const std::string*&  keyword_;
+	bool&                several_;
+};
+
+void CommandIndex::match(const BasicStringContainer_t& tokens, size_t count, Match& result,
+		GroupMask_t groups) const
+{
+	EntryContainer_t& found = result.entries_;
+	FrontierType_t& frontier = result.frontier_;
+	FrontierType_t next(frontier.get_allocator());
+
+	found.clear();
+	result.keywords_.clear();
+
+	count = std::min(count, tokens.size());
+	result.keywords_.reserve(count);
+
+	frontier.assign(1, root_.get());
+	append(*root_, groups, found);
+
+	size_t depth = 0;
+	size_t ambiguous = count;
+
+	for (; depth < count; ++depth)
+	{
+		const std::string& token = tokens[depth];
+
+		// spells the root of every trie, yet no keyword is empty
+		if (token.empty())
+			break;
+
+		next.clear();
+
+		const std::string* keyword = NULL;
+		bool several = false;
+
+		for (FrontierType_t::const_iterator nodeIt = frontier.begin(); nodeIt != frontier.end(); ++nodeIt)
+		{
+			const PrefixTrie_t& prefixes = (*nodeIt)->prefixes;
+			PrefixTrie_t::Index_t vertex = prefixes.find(token);
+
+			if (vertex == PrefixTrie_t::NONE)
+				continue;
+
+			Selection select(prefixes, groups, next, keyword, several);
+			PrefixTrie_t::Index_t exact = prefixes.exact(vertex);
+
+			if (exact != PrefixTrie_t::NONE)
+				select(exact);
+			else
+				prefixes.visit(vertex, select);
+		}
+
+		if (next.empty())
+			break;
+
+		result.keywords_.push_back(several ? NULL : keyword);
+
+		if (several && ambiguous == count)
+			ambiguous = depth;
+
+		for (FrontierType_t::const_iterator It = next.begin(); It != next.end(); ++It)
+			append(**It, groups, found);
+
+		frontier.swap(next);
+	}
+
+	result.depth_ = depth;
+	result.ambiguous_ = std::min(ambiguous, depth);
+	result.exhausted_ = false;
+	result.groups_ = groups;
+
+	if (depth == count)
+	{
+		for (FrontierType_t::const_iterator nodeIt = frontier.begin(); nodeIt != frontier.end() && !result.exhausted_; ++nodeIt)
+		{
+			ChildrenType_t::const_iterator It = (*nodeIt)->children.begin();
+			for (; It != (*nodeIt)->children.end(); ++It)
+			{
+				if (It->second->groups.load(boost::memory_order_relaxed) & groups)
+				{
+					result.exhausted_ = true;
+					break;
+				}
+			}
+		}
+	}
+
+	sorted(found, result.commands_, &result.depths_);
+}
+
+void CommandIndex::ambiguity(const BasicStringContainer_t& tokens, const Match& match,
+		CompletionContainer_t& keywords) const
+{
+	keywords.clear();
+
+	if (match.ambiguous_ >= match.depth_)
+		return;
+
+	// the nodes the ambiguous token was matched at
+	Match before;
+	this->match(tokens, match.ambiguous_, before, match.groups_);
+
+	abbreviated(before, tokens[match.ambiguous_], keywords);
+
+	std::sort(keywords.begin(), keywords.end());
+	keywords.erase(std::unique(keywords.begin(), keywords.end()), keywords.end());
+}
+
+/* Keywords allowed to the groups of the match which follow it and start with text */
+void CommandIndex::abbreviated(const Match& match, const std::string& text, CompletionContainer_t& keywords)
+{
+	for (FrontierType_t::const_iterator nodeIt = match.frontier_.begin(); nodeIt != match.frontier_.end(); ++nodeIt)
+	{
+		ChildrenType_t::const_iterator It = (*nodeIt)->children.lower_bound(text);
+
+		for (; It != (*nodeIt)->children.end() && startsWith(It->first, text); ++It)
+		{
+			if (It->second->groups.load(boost::memory_order_relaxed) & match.groups_)
+				keywords.push_back(It->first);
+		}
+	}
+}
+
+void CommandIndex::reachable(const Match& match, CandidateContainer_t& candidates,
+		DepthContainer_t* depths) const
+{
+	EntryContainer_t found(match.entries_);
+
+	if (match.exhausted_)
+	{
+		for (FrontierType_t::const_iterator nodeIt = match.frontier_.begin(); nodeIt != match.frontier_.end(); ++nodeIt)
+		{
+			// commands of the frontier nodes are already matched
+			ChildrenType_t::const_iterator It = (*nodeIt)->children.begin();
+			for (; It != (*nodeIt)->children.end(); ++It)
+				collect(*It->second, match.groups_, found);
+		}
+	}
+
+	sorted(found, candidates, depths);
+}
+
+void CommandIndex::suggest(const Match& match, const std::string& token, size_t limit,
+		CompletionContainer_t& suggestions) const
+{
+	suggestions.clear();
+
+	BasicStringContainer_t found;
+
+	for (FrontierType_t::const_iterator nodeIt = match.frontier_.begin(); nodeIt != match.frontier_.end(); ++nodeIt)
+	{
+		(*nodeIt)->keywords.find(token, suggestionDistance(token), found);
+
+		for (BasicStringContainer_t::const_iterator It = found.begin(); It != found.end(); ++It)
+		{
+			ChildrenType_t::const_iterator childIt = (*nodeIt)->children.find(*It);
+
+			if (childIt->second->groups.load(boost::memory_order_relaxed) & match.groups_)
+				suggestions.push_back(*It);
+		}
+	}
+
+	// the frontier holds several nodes after an abbreviation
+	CompletionContainer_t::iterator last = suggestions.end();
+	for (CompletionContainer_t::iterator It = suggestions.begin(); It != last; ++It)
+		last = std::remove(It + 1, last, *It);
+
+	suggestions.erase(last, suggestions.end());
+
+	if (suggestions.size() > limit)
+		suggestions.resize(limit);
+}
+
+void CommandIndex::complete(const Match& match, const BasicStringContainer_t& line,
+		const std::string& text, CompletionContainer_t& matches) const
+{
+	matches.clear();
+
+	// keywords only follow when the whole line was matched
+	if (match.exhausted_)
+		abbreviated(match, text, matches);
+
+	bool get = text.empty();
+
+	for (CandidateContainer_t::const_iterator It = match.commands_.begin(); It != match.commands_.end(); ++It)
+	{
+		int startWithIndex = 0;
+
+		// a command keeps startWithIndex non-zero while it has more values
+		for (size_t i = 0; i < MAX_PROVIDED_VALUES; ++i)
+		{
+			char* value = (*It)->command->completion(get, line, startWithIndex);
+
+			if (value == NULL)
+				break;
+
+			matches.push_back(value);
+			free(value);
+
+			if (startWithIndex == 0)
+				break;
+		}
+	}
+
+	std::sort(matches.begin(), matches.end());
+	matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+}
+
+} // CLI
@@ -0,0 +1,294 @@
+/*
+ * cliCommandIndex.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLICOMMANDINDEX_H_
+#define CLICOMMANDINDEX_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "cliApi.h"
+#include "cliArena.h"
+#include "cliCommand.h"
+#include "cliKeywordTree.h"
+#include "cliPrefixTrie.h"
+
+namespace CLI {
+
+	/* How a command may run next to the others */
+	enum CommandAccess_t
+	{
+		CLI_ACCESS_EXCLUSIVE,   // changes state, runs alone under cliSync
+		CLI_ACCESS_SHARED       // read only, runs concurrently with other shared commands
+	};
+
+	class CommandStatistics;
+
+	/*
+	 * Reuse of command output. A command with a time to live prints the
+	 * same for the same parameters and group until it is over, e.g. an
+	 * expensive "show"; repeated lines are answered from ResultCache.
+	 * Only what the command writes to commandOutput() is kept, output
+	 * printed to stdout is lost on a hit. A command printing nothing to
+	 * commandOutput() is run every time.
+	 */
+	struct CachePolicy
+	{
+		CachePolicy() : ttl(0) {}
+		explicit CachePolicy(unsigned ms) : ttl(ms) {}
+
+		unsigned                ttl;           // ms, 0 if the output is not reused
+		BasicStringContainer_t  tags;          // what the output shows
+		BasicStringContainer_t  invalidates;   // tags dropped once the command ran, or its batch committed
+	};
+
+	/* One bit per user group, see groupMask() */
+	typedef boost::uint64_t GroupMask_t;
+
+	const GroupMask_t CLI_GROUPS_ALL = ~static_cast<GroupMask_t>(0);
+
+	/* Registered command together with what the engine knows about it */
+	struct CommandInfo
+	{
+		explicit CommandInfo(const CommandPtr_t& cmd, CommandAccess_t acc = CLI_ACCESS_EXCLUSIVE,
+				securityHook hk = NULL) :
+			command(cmd), access(acc), statistics(NULL), hook(hk), groups(hk ? 0 : CLI_GROUPS_ALL)
+		{}
+
+		CommandPtr_t       command;
+		CommandAccess_t    access;
+		CommandStatistics* statistics;   // owned by Statistics, NULL if not counted
+		CachePolicy        cache;
+
+		/*
+		 * Groups allowed to use the command. The hook is asked once for
+		 * every group when the group is first seen, the bits only grow.
+		 */
+		securityHook                        hook;
+		mutable boost::atomic<GroupMask_t>  groups;
+	};
+
+	typedef boost::shared_ptr<const CommandInfo> CommandInfoPtr_t;
+
+	/* Registration of a command declaring its access */
+	void registerCommand(const ModulePtr_t& module,
+			const CommandPtr_t& command,
+			securityHook hook,
+			Context_t context,
+			CommandAccess_t access);
+
+	/* Registration of a command whose output may be reused or drops reused output */
+	void registerCommand(const ModulePtr_t& module,
+			const CommandPtr_t& command,
+			securityHook hook,
+			Context_t context,
+			CommandAccess_t access,
+			const CachePolicy& cache);
+
+	/*
+	 * Keyword trie over the leading keywords of registered commands.
+	 *
+	 * Every command is placed at the node reached by its fixed keyword
+	 * path (e.g. "show interface" -> root/show/interface). Commands whose
+	 * leading keywords cannot be discovered stay at the root and are always
+	 * reported as candidates, so the index never hides a command that
+	 * Command::validate would accept.
+	 *
+	 * Nodes are never changed once they are shared: insert() copies the
+	 * shared nodes along the keyword path, so a copy of an index is a cheap
+	 * snapshot which stays valid while the original grows.
+	 *
+	 * A line is matched against the trie once; dispatch, context help,
+	 * completion and error position all come from the resulting Match.
+	 */
+	class CommandIndex
+	{
+		private:
+			struct Entry
+			{
+				size_t           order;
+				size_t           depth;   // keywords on the path of the command
+				CommandInfoPtr_t info;
+			};
+
+			struct Node;
+			struct Selection;
+			typedef std::vector<const Node*, ArenaAllocator<const Node*> > FrontierType_t;
+			typedef std::vector<Entry, ArenaAllocator<Entry> >             EntryContainer_t;
+			typedef std::vector<const std::string*, ArenaAllocator<const std::string*> > KeywordContainer_t;
+
+		public:
+			typedef std::vector<CommandInfoPtr_t, ArenaAllocator<CommandInfoPtr_t> > CandidateContainer_t;
+			typedef std::vector<size_t, ArenaAllocator<size_t> >                     DepthContainer_t;
+			typedef std::vector<std::string>  CompletionContainer_t;
+
+			CommandIndex();
+
+			void insert(const CommandInfoPtr_t& info);
+			void insert(const CommandPtr_t& command)
+			{
+				insert(CommandInfoPtr_t(new CommandInfo(command)));
+			}
+
+			void clear();
+
+			size_t size() const { return size_; }
+
+			/*
+			 * State reached by the tokens of a line. It refers to the nodes of
+			 * the index and is valid as long as the index is. Given an arena,
+			 * its containers live there and must not outlive its reset.
+			 */
+			class Match
+			{
+				public:
+					explicit Match(Arena* arena = NULL) :
+						depth_(0), ambiguous_(0), exhausted_(false), groups_(CLI_GROUPS_ALL),
+						frontier_(ArenaAllocator<const Node*>(arena)),
+						entries_(ArenaAllocator<Entry>(arena)),
+						commands_(ArenaAllocator<CommandInfoPtr_t>(arena)),
+						depths_(ArenaAllocator<size_t>(arena)),
+						keywords_(ArenaAllocator<const std::string*>(arena))
+					{}
+
+					/* Tokens consumed by keywords */
+					size_t depth() const { return depth_; }
+
+					/* Keyword a consumed token stands for, NULL if it abbreviates several */
+					const std::string* keyword(size_t index) const { return keywords_[index]; }
+
+					/* First consumed token abbreviating several keywords, depth() if none */
+					size_t ambiguous() const { return ambiguous_; }
+
+					/* All tokens are keywords but the keyword path goes on */
+					bool exhausted() const { return exhausted_; }
+
+					/* Commands whose keyword path is a prefix of the tokens, in registration order */
+					const CandidateContainer_t& commands() const { return commands_; }
+
+					/*
+					 * Keywords on the path of commands()[candidate]. Tokens
+					 * beyond are parameters to that command, even if they
+					 * matched a keyword of another one.
+					 */
+					size_t depth(size_t candidate) const { return depths_[candidate]; }
+
+				private:
+					friend class CommandIndex;
+
+					size_t               depth_;
+					size_t               ambiguous_;
+					bool                 exhausted_;
+					GroupMask_t          groups_;
+					FrontierType_t       frontier_;
+					EntryContainer_t     entries_;
+					CandidateContainer_t commands_;
+					DepthContainer_t     depths_;
+					KeywordContainer_t   keywords_;
+			};
+
+			/*
+			 * Single pass of the first 'count' tokens over the trie. A token
+			 * equal to a keyword selects it, otherwise it is an abbreviation
+			 * and selects every keyword it starts; either costs steps in the
+			 * length of the token only. An empty token, typed as "", is never
+			 * a keyword. Only commands allowed to one of 'groups' are seen,
+			 * by the match and by everything derived from it.
+			 */
+			void match(const BasicStringContainer_t& tokens, size_t count, Match& result,
+					GroupMask_t groups = CLI_GROUPS_ALL) const;
+
+			/*
+			 * Commands which may continue the matched tokens: those on the
+			 * keyword path and those below it, in registration order.
+			 * 'depths' receives the length of their keyword paths.
+			 */
+			void reachable(const Match& match, CandidateContainer_t& candidates,
+					DepthContainer_t* depths = NULL) const;
+
+			/*
+			 * Completion candidates for the word being typed after the matched
+			 * tokens. 'line' holds the tokens up to the cursor. Keywords come
+			 * from the sorted children of the reached nodes; commands on the
+			 * keyword path act as providers of dynamic values through
+			 * Command::completion. Matches are sorted and unique.
+			 */
+			void complete(const Match& match, const BasicStringContainer_t& line,
+					const std::string& text, CompletionContainer_t& matches) const;
+
+			/* Keywords the ambiguous token of the match abbreviates, sorted */
+			void ambiguity(const BasicStringContainer_t& tokens, const Match& match,
+					CompletionContainer_t& keywords) const;
+
+			/*
+			 * Keywords close to the token which stopped the match, those the
+			 * token might have been meant to be. Closest first, at most
+			 * 'limit' of them.
+			 */
+			void suggest(const Match& match, const std::string& token, size_t limit,
+					CompletionContainer_t& suggestions) const;
+
+			/* All commands in registration order */
+			void commands(CandidateContainer_t& all) const;
+
+			/*
+			 * Recomputes the group bits of the nodes after groups were added
+			 * to the commands. Nodes shared with snapshots are updated too,
+			 * the bits only grow.
+			 */
+			void refreshGroups() const;
+
+			typedef std::vector<BasicStringContainer_t> HelpLevelContainer_t;
+
+			/*
+			 * Fixed keywords of a command, as reported by its context help.
+			 * 'levels' receives the help seen after each keyword of the path.
+			 */
+			static void keywordPath(const CommandPtr_t& command, BasicStringContainer_t& path,
+					HelpLevelContainer_t* levels = NULL);
+
+		private:
+			typedef boost::shared_ptr<Node> NodePtr_t;
+			typedef std::map<std::string, NodePtr_t> ChildrenType_t;
+			typedef PrefixTrie<const Node*> PrefixTrie_t;
+
+			struct Node
+			{
+				Node() : groups(0) {}
+				Node(const Node& other) :
+					children(other.children), prefixes(other.prefixes), keywords(other.keywords),
+					commands(other.commands), groups(other.groups.load())
+				{}
+
+				ChildrenType_t     children;
+				PrefixTrie_t       prefixes;   // keys of children, for abbreviations
+				KeywordTree        keywords;   // keys of children, for suggestions
+				std::vector<Entry> commands;
+
+				/* Groups allowed to a command of the subtree, a single AND skips it */
+				mutable boost::atomic<GroupMask_t> groups;
+			};
+
+			static GroupMask_t refreshGroups(const Node& node);
+			static void collect(const Node& node, GroupMask_t groups, EntryContainer_t& found);
+			static void append(const Node& node, GroupMask_t groups, EntryContainer_t& found);
+			static void sorted(EntryContainer_t& found, CandidateContainer_t& candidates,
+					DepthContainer_t* depths = NULL);
+			static void abbreviated(const Match& match, const std::string& text, CompletionContainer_t& keywords);
+
+			NodePtr_t root_;
+			size_t    size_;
+	};
+
+} // CLI
+
+#endif /* CLICOMMANDINDEX_H_ */
@@ -5,20 +5,42 @@
  *      Author: ast
  */
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include <readline/history.h>
 #include <readline/readline.h>
 
-#include <boost/algorithm/string/trim.hpp>
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+#include <boost/ref.hpp>
+#include <boost/utility/in_place_factory.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
 #include "cliApi.h"
 
 #include "cliCommand.h"
+#include "cliCommandIndex.h"
 #include "cliEngine.h"
+#include "cliFilter.h"
+#include "cliHelpCache.h"
+#include "cliHistory.h"
+#include "cliJobs.h"
+#include "cliRecorder.h"
+#include "cliRegistrySnapshot.h"
+#include "cliResultCache.h"
+#include "cliSession.h"
+#include "cliStatistics.h"
+#include "cliTokenizer.h"
 #include "cliUtils.h"
 #include "auxilary.h"
 #include "adtauth.h"
@@ -39,40 +61,296 @@ namespace CLI {
 	/* Forward declaration */
 namespace {
 
-	std::vector<std::string> tokens;
 	typedef std::vector<std::string>::const_iterator TokenConstIt_t;
-	ParameterStorageType_t paramStorage;
-	std::vector<std::string> contextHelp;
 
-	AdtAuth::AdtGroup currentGroup;
-	AdtAuth::AdtUser currentUser;
+	/* Lines of history kept by sessions without readline */
+	const size_t SESSION_HISTORY_SIZE = 500;
 
-	std::string cmdText;
+	/* Keywords offered for a mistyped one */
+	const size_t MAX_SUGGESTIONS = 5;
+
+	/* Commands a line with lists may expand to */
+	const size_t MAX_FANOUT = 1024;
+
+	/* Lines of the context history file loaded into readline */
+	const size_t READLINE_HISTORY_SIZE = 1000;
+
+	const boost::uint64_t NS_PER_MS = 1000000;
+
+	/* Sessions made so far, numbers them */
+	boost::atomic<unsigned> sessionCount(0);
+
+	Session console;
+
+	/* Session the engine is working for */
+	Session* session = &console;
+
+	/*
+	 * Makes the engine work for another session for the life time
+	 * of the object
+	 */
+	class SessionSwitch
+	{
+		public:
+			explicit SessionSwitch(Session& target) :
+				previous_(session)
+			{
+				activate(target);
+			}
+
+			~SessionSwitch()
+			{
+				activate(*previous_);
+			}
+
+		private:
+			static void activate(Session& target)
+			{
+				session = &target;
+
+				if (Engine::Instance().getContext() != target.context)
+					Engine::Instance().setContext(target.context);
+			}
+
+			Session* previous_;
+	};
+
+	/*
+	 * Keeps what is written to the stream for the life time
+	 * of the object
+	 */
+	class OutputCapture
+	{
+		public:
+			explicit OutputCapture(std::ostream& out) :
+				out_(out), previous_(out.rdbuf(&buffer_))
+			{}
+
+			~OutputCapture()
+			{
+				out_.rdbuf(previous_);
+			}
+
+			std::string text() const { return buffer_.str(); }
+
+		private:
+			std::ostream&   out_;
+			std::stringbuf  buffer_;
+			std::streambuf* previous_;
+	};
+
+	typedef boost::shared_ptr<const CommandIndex> CommandIndexPtr_t;
+	typedef boost::shared_ptr<CommandIndex> PublishedIndexPtr_t;
+
+	/*
+	 * What the engine keeps for every context, so that entering one only
+	 * swaps the pointer to its state. Lookups never see the commands of
+	 * other contexts.
+	 */
+	struct ContextState
+	{
+		ContextState() : commands(NULL), history(NULL) {}
+
+		/*
+		 * Published snapshot of the command index. Registration builds a
+		 * new snapshot and swaps it in under registrySync, lookups only
+		 * hold the lock while taking their reference.
+		 */
+		PublishedIndexPtr_t              index;
+		Engine::CommandStorageType_t*    commands;   // Engine::commands() of the context
+
+		/* Readline history put aside while the console is in another context */
+		HISTORY_STATE*                   history;
+
+		/* Prompt of the line being read, see contextPrompt() */
+		std::string                      prompt;
+	};
+
+	/* Entries are never erased, pointers to them stay valid */
+	typedef std::map<Context_t, ContextState> ContextStateType_t;
+
+	ContextStateType_t contextStates;
+	boost::shared_mutex registrySync;
+
+	/* State of the context the engine is in, see Engine::setContext() */
+	ContextState* activeContext = NULL;
+
+	/*
+	 * Registry snapshot of the previous start, if it matches this one,
+	 * and the factory registrations of this start to write the next one
+	 */
+	RegistrySnapshotPtr_t registrySnapshot;
+	RegistrySnapshot::EntryContainer_t snapshotEntries;
+	bool snapshotStale = false;
+
+	/*
+	 * Bits of the user groups seen so far and the registered commands
+	 * whose hooks have to be asked when another group shows up
+	 */
+	const size_t MAX_GROUPS = 64;
+
+	typedef std::map<std::string, unsigned> GroupBitType_t;
+	typedef std::map<const Command*, CommandInfoPtr_t> RegisteredCommandType_t;
+
+	GroupBitType_t groupBits;
+	RegisteredCommandType_t registeredCommands;
+
+	/* Context help results, cleared whenever a snapshot is replaced */
+	const size_t HELP_CACHE_SIZE = 256;
+	HelpCache helpCache(HELP_CACHE_SIZE);
+
+	/* Shared by CLI_ACCESS_SHARED commands, exclusive for the others */
+	boost::shared_mutex executionSync;
+
+	typedef boost::shared_lock<boost::shared_mutex> ReadLock_t;
+	typedef boost::unique_lock<boost::shared_mutex> WriteLock_t;
+
+	/*
+	 * Held while a command runs: shared commands run side by side,
+	 * exclusive ones run alone and under cliSync
+	 */
+	class ExecutionLock
+	{
+		public:
+			explicit ExecutionLock(CommandAccess_t access) :
+				exclusive_(executionSync, boost::defer_lock),
+				shared_(executionSync, boost::defer_lock)
+			{
+				StageTimer wait(CLI_STAGE_LOCK_WAIT);
+
+				if (access == CLI_ACCESS_SHARED)
+				{
+					shared_.lock();
+				}
+				else
+				{
+					global_ = boost::in_place(boost::ref(CLI::cliSync));
+					exclusive_.lock();
+				}
+			}
+
+		private:
+			// held in place, taking the locks allocates nothing
+			boost::optional<CLI::scopedLockSync> global_;
+			WriteLock_t                          exclusive_;
+			ReadLock_t                           shared_;
+	};
 
 	int QuestionMarkKeyMap(int , int);
+	int ReverseSearchKeyMap(int , int);
 	char ** UserCompletion(const char* text, int start, int end);
 	char * Generator(const char*  text, int  state);
 
-	void split_into_tokens_int (const std::string& stream, BasicStringContainer_t& array);
+	Tokenizer lineTokenizer;
+
+	/* Console line as typed, it goes to history instead of the joined tokens */
+	std::string consoleLine;
+
+	/* Context whose history readline holds */
+	bool readlineHistoryLoaded = false;
+	Context_t readlineContext = CLI_CTX_NORMAL;
+
+	ContextState& contextState(Context_t context);
+	ContextState& currentContext();
+	const std::string& contextPrompt();
+	void loadReadlineHistory(Context_t context);
+	void switchReadlineHistory(Context_t context);
+
+	CommandIndexPtr_t contextIndex();
+
+	/*
+	 * Position in the completion matches of the current TAB press,
+	 * readline pulls them one by one through Generator.
+	 */
+	class CompletionCursor
+	{
+		public:
+			CompletionCursor() : position_(0) {}
+
+			void reset(const BasicStringContainer_t& line, const char* text);
+			char * next();
+
+		private:
+			CommandIndex::CompletionContainer_t matches_;
+			size_t position_;
+	};
+
+	CompletionCursor completionCursor;
+	CommandInfoPtr_t lookupCommand(const BasicStringContainer_t& tokens, ParameterStorageType_t& paramStorage, CommandError_t& cmdError);
+	const BasicStringContainer_t& expandKeywords(const BasicStringContainer_t& tokens,
+			const CommandIndex::Match& match, size_t depth, BasicStringContainer_t& expanded);
+
+	bool helpRequested(Session& target);
+	void printContextHelp(Session& target);
+	void printCommandHelp(Session& target);
+	bool executeTokens(Session& target);
+	bool runTransactionCommand(Session& target, bool* failed);
+	void runForeground(Session& target, const CommandInfo& info, OutputFilter& filter);
+	void startJob(Session& target, const CommandInfoPtr_t& info);
+	void runJob(const CommandInfoPtr_t& info, const ParameterStorageType_t& paramStorage,
+			const std::string& group, const BasicStringContainer_t& filterTokens, Job& job);
+
+	/* One of the commands a line with lists expands to */
+	struct Invocation
+	{
+		CommandInfoPtr_t        info;
+		ParameterStorageType_t  paramStorage;
+		JobPtr_t                job;
+	};
+
+	bool fanOut(Session& target, OutputFilter& filter, bool background);
+
+	CommandInfoPtr_t commandInfo(const CommandPtr_t& command, CommandAccess_t access, securityHook hook,
+			const CachePolicy& cache = CachePolicy());
+	void publishCommand(const ModulePtr_t& module, const CommandPtr_t& command,
+			Context_t context, CommandAccess_t access, securityHook hook, const CachePolicy& cache);
+
+	GroupMask_t groupMask(const std::string& group);
+	GroupMask_t sessionGroups(Session& target);
+	std::string snapshotIdentity(const std::string& build);
+	void runCommand(const CommandInfo& info, const ParameterStorageType_t& paramStorage, const std::string& group);
+	void runCached(const CommandInfo& info, const ParameterStorageType_t& paramStorage, const std::string& group,
+			boost::uint64_t now);
 
 	class LookupFunctor
 	{
 		public:
 				// Creates a functor and memorises tokens
-			LookupFunctor( const vector< string > &  tokens, CommandError_t & cmdError ) :
-				tokens_( tokens ), cmdError_(cmdError)
+			LookupFunctor( const vector< string > &  tokens, ParameterStorageType_t & paramStorage, CommandError_t & cmdError ) :
+				tokens_( tokens ), paramStorage_( paramStorage ), cmdError_(cmdError)
 			{}
 
 			bool operator()( const Engine::ElementType_t&  elem ) const
 			{
 				CommandPtr_t cmd = elem.second;
 
-				return cmd->validate(tokens_, paramStorage, cmdError_);
+				return (*this)(cmd);
+
+			}
+
+			bool operator()( const CommandPtr_t&  cmd ) const
+			{
+				CommandError_t  error;
+				error.position = tokens_.begin();
+
+				if (cmd->validate(tokens_, paramStorage_, error))
+					return true;
+
+				// the command which got furthest tells what is wrong
+				if (error.position >= cmdError_.position)
+					cmdError_ = error;
 
+				return false;
+			}
+
+			bool operator()( const CommandInfoPtr_t&  info ) const
+			{
+				return (*this)(info->command);
 			}
 
 		private:
 			const vector< string > &  tokens_;
+			ParameterStorageType_t &  paramStorage_;
 			CommandError_t& cmdError_;
 	};
 
@@ -81,29 +359,37 @@ namespace {
 	{
 		public:
 				// Creates a functor and memorises tokens
-			ContextFunctor( const vector< string > &  tokens , CommandError_t & cmdError ) :
-				tokens_( tokens ), cmdError_(cmdError)
-			{
-				contextHelp.clear();
-			}
+			ContextFunctor( const vector< string > & tokens, Session & target, CommandError_t & cmdError ) :
+				tokens_( tokens ), paramStorage_( target.paramStorage ),
+				contextHelp_( target.contextHelp ), cmdError_(cmdError)
+			{}
 
 			void operator()( const Engine::ElementType_t&  elem) const
 			{
+				(*this)(elem.second);
+			}
 
-				CommandPtr_t cmd = elem.second;
+			void operator()( const CommandInfoPtr_t&  info) const
+			{
+				(*this)(info->command);
+			}
 
-				cmd->getContextHelp(tokens_, contextHelp);
+			void operator()( const CommandPtr_t&  cmd) const
+			{
+				cmd->getContextHelp(tokens_, contextHelp_);
 
-				bool canBeCompleted = cmd->validate(tokens_, paramStorage, cmdError_);
+				bool canBeCompleted = cmd->validate(tokens_, paramStorage_, cmdError_);
 
 				if (canBeCompleted == true)
 				{
-					contextHelp.push_back("<cr>");
+					contextHelp_.push_back("<cr>");
 				}
 			}
 
 		private:
 			const vector< string > &  tokens_;
+			ParameterStorageType_t &  paramStorage_;
+			BasicStringContainer_t &  contextHelp_;
 			CommandError_t & cmdError_;
 	};
 
@@ -113,7 +399,7 @@ namespace {
 	 */
 	int preinputhook()
 	{
-		rl_insert_text(cmdText.c_str());
+		rl_insert_text(console.cmdText.c_str());
 		rl_redisplay();
 		return 0;
 	}
@@ -127,12 +413,28 @@ void registerCommand(const ModulePtr_t& module,
 		securityHook hook,
 		Context_t context)
 {
-	// TODO: current group should be an array
-	// here we should use foreach
-	if (hook (currentGroup.name()) == true || currentUser.isRoot() == true)
-	{
-		Engine::Instance().registerCommand(module, command, context);
-	}
+	registerCommand(module, command, hook, context, CLI_ACCESS_EXCLUSIVE);
+}
+
+void registerCommand(const ModulePtr_t& module,
+		const CommandPtr_t& command,
+		securityHook hook,
+		Context_t context,
+		CommandAccess_t access)
+{
+	registerCommand(module, command, hook, context, access, CachePolicy());
+}
+
+void registerCommand(const ModulePtr_t& module,
+		const CommandPtr_t& command,
+		securityHook hook,
+		Context_t context,
+		CommandAccess_t access,
+		const CachePolicy& cache)
+{
+	// every command is registered, the groups allowed to use it are
+	// kept as bits and checked while the index is matched
+	publishCommand(module, command, context, access, hook, cache);
 #if 0
 	if (currentUser.isMemberOfGroup(AdtAuth::ADT_ADMIN) ||
 	   currentUser.isMemberOfGroup(AdtAuth::ADT_ROOT) || security == AdtAuth::ADT_ANY
@@ -149,53 +451,218 @@ void registerCommand(const ModulePtr_t& module,
 #endif
 }
 
+void registerCommand(const ModulePtr_t& module,
+		const std::string& key,
+		const CommandFactory_t& factory,
+		securityHook hook,
+		Context_t context,
+		CommandAccess_t access,
+		const CachePolicy& cache)
+{
+	RegistrySnapshot::Entry entry;
+	entry.context = context;
+	entry.key = key;
+	entry.access = access;
+
+	int record = registrySnapshot ? registrySnapshot->find(context, key) : -1;
+
+	if (record >= 0)
+		entry.command.reset(new SnapshotCommand(registrySnapshot, record, factory));
+	else
+	{
+		snapshotStale = true;
+		entry.command = factory();
+	}
+
+	if (entry.command)
+		publishCommand(module, entry.command, context, access, hook, cache);
+
+	snapshotEntries.push_back(entry);
+}
+
+bool loadRegistrySnapshot(const std::string& path, const std::string& build)
+{
+	boost::shared_ptr<RegistrySnapshot> snapshot(new RegistrySnapshot);
+
+	if (!snapshot->open(path, snapshotIdentity(build)))
+		return false;
+
+	registrySnapshot = snapshot;
+	return true;
+}
+
+bool saveRegistrySnapshot(const std::string& path, const std::string& build)
+{
+	if (registrySnapshot && !snapshotStale && registrySnapshot->size() == snapshotEntries.size())
+		return true;
+
+	return RegistrySnapshot::save(path, snapshotIdentity(build), snapshotEntries);
+}
+
 ModulePtr_t createModule(const std::string& module, const std::string& help, Context_t context)
 {
 	return Engine::Instance().registerModule(module, help, context);
 }
 
+Session::Session() :
+	id(++sessionCount),
+	permissions(0),
+	permissionsCount(0),
+	context(CLI_CTX_NORMAL),
+	deferWait(false)
+{
+}
+
+Session& consoleSession()
+{
+	return console;
+}
+
+Session& currentSession()
+{
+	return *session;
+}
+
+bool executeLine(Session& target, const std::string& line)
+{
+	recordLine(target, line);
+
+	SessionSwitch activate(target);
+
+	Context_t typed = target.context;
+
+	{
+		StageTimer tokenize(CLI_STAGE_TOKENIZE);
+
+		lineTokenizer.split(line);
+		lineTokenizer.assign(target.tokens, target.filter);
+	}
+
+	if (target.tokens.empty())
+		return true;
+
+	if (helpRequested(target))
+	{
+		printContextHelp(target);
+		return true;
+	}
+
+	if (!executeTokens(target))
+		return false;
+
+	// a full history reuses the string of its oldest line
+	if (target.history.size() >= SESSION_HISTORY_SIZE)
+	{
+		std::rotate(target.history.begin(), target.history.begin() + 1, target.history.end());
+		target.history.back().assign(line);
+	}
+	else
+		target.history.push_back(line);
+
+	contextHistory(typed).append(line);
+
+	return true;
+}
+
+/*
+ * Same as a line without filters, background or context help, but the
+ * tokens are taken as they are and nothing is printed for a rejected
+ * command or kept in the history
+ */
+bool executeCommand(Session& target, const BasicStringContainer_t& tokens, CommandError_t& cmdError)
+{
+	SessionSwitch activate(target);
+	Arena::Scope releaseArena( target.arena );
+
+	// the strings of the previous line are reused
+	target.tokens.resize(tokens.size());
+	for (size_t i = 0; i < tokens.size(); ++i)
+		target.tokens[i].assign(tokens[i]);
+
+	target.filter.clear();
+
+	cmdError.position = target.tokens.begin();
+	cmdError.description.clear();
+
+	if (target.tokens.empty())
+		return true;
+
+	bool failed = false;
+
+	if (jobCommand(&target, target.tokens, target.deferWait ? &target.waiting : NULL) ||
+			runTransactionCommand(target, &failed))
+		return !failed;
+
+	CommandInfoPtr_t info = lookupCommand(target.tokens, target.paramStorage, cmdError);
+
+	if (!info)
+		return false;
+
+	OutputFilter filter;
+	ExecutionLock lockExecution( info->access );
+
+	runForeground(target, *info, filter);
+
+	return true;
+}
+
+std::string sessionPrompt(Session& target)
+{
+	SessionSwitch activate(target);
+
+	return contextPrompt();
+}
+
 
 
 Engine::Engine()
 {
 	::using_history();
 	::rl_bind_key('?', QuestionMarkKeyMap);
+	::rl_bind_key(CTRL('r'), ReverseSearchKeyMap);
 	::rl_variable_bind("print-completions-horizontally", "off");
 	rl_attempted_completion_function = UserCompletion;
 	context_ = CLI_CTX_NORMAL;
 }
 
 
-void printErrorMsg (std::vector<std::string>& tokens, const std::string& prompt, const CommandError_t&  cmdError)
+void printErrorMsg (const std::vector<std::string>& tokens, const std::string& prompt, const CommandError_t&  cmdError)
 {
-	int count = printf("%s: ", prompt.c_str());
+	OutputSink& output = session->output;
+	std::ostream& out = output.stream();
+
+	out << prompt << ": ";
+	size_t count = prompt.size() + 2;
 
 	TokenConstIt_t begin = tokens.begin();
 	TokenConstIt_t end = tokens.end();
 
-	string spacer;
-	string output;
+	const char* spacer = "";
+	size_t marker = 0;
 
 	for (; begin != end; ++begin)
 	{
-		count += printf ("%s", spacer.c_str());
+		out << spacer;
+		count += strlen(spacer);
 		if (begin == cmdError.position)
 		{
-			output.insert(output.begin(), count, ' ');
+			marker = count;
 		}
-		count += printf ("%s", (*begin).c_str());
+		out << *begin;
+		count += begin->size();
 		spacer=" ";
 	}
-	printf("\n");
-	printf("%s^\n", output.c_str());
+	out << '\n';
+	output.pad(marker);
+	out << "^\n";
 }
 
-void processErrorMsg(const CommandError_t&  cmdError)
+void processErrorMsg(const std::vector<std::string>& tokens, const CommandError_t&  cmdError)
 {
 	switch (cmdError.error)
 	{
 	case CLI_CMD_SHORT:
-		std::cout << TR("Incomplete command") << std::endl;
+		session->output.stream() << TR("Incomplete command") << '\n';
 		break;
 	case CLI_CMD_TOO_LONG:
 	{
@@ -204,13 +671,21 @@ void processErrorMsg(const CommandError_t&  cmdError)
 	}
 	case CLI_CMD_WRONG_KEYWORD:
 	{
-		printErrorMsg(tokens,TR("Unknown keyword"), cmdError);
+		// the keywords listed for an abbreviation start with it, suggestions
+		// for a mistyped keyword never do
+		bool ambiguous = !cmdError.description.empty() && cmdError.position != tokens.end() &&
+				cmdError.description.compare(0, cmdError.position->size(), *cmdError.position) == 0;
+
+		printErrorMsg(tokens, ambiguous ? TR("Ambiguous keyword") : TR("Unknown keyword"), cmdError);
+
+		if (!cmdError.description.empty())
+			session->output.stream() << (ambiguous ? TR("It may be") : TR("Did you mean")) << ": " << cmdError.description << '\n';
 		break;
 	}
 	case CLI_CMD_WRONG_VALUE:
 	{
 		printErrorMsg(tokens,TR("Error in parameter value"), cmdError);
-		printf("Valid value: %s\n", cmdError.description.c_str());
+		session->output.stream() << "Valid value: " << cmdError.description << '\n';
 		break;
 	}
 	default:
@@ -221,16 +696,32 @@ void processErrorMsg(const CommandError_t&  cmdError)
 
 void Engine::Run()
 {
+	// commands piped into the CLI are executed without readline
+	if (!isatty(STDIN_FILENO))
+	{
+		RunBatch(std::cin);
+		return;
+	}
+
+	if (!readlineHistoryLoaded)
+		loadReadlineHistory(getContext());
+
 	for (;;)
 	{
 		if (stop_to_work)
 			return;
 
-		bool result =  readLine(CLI::Engine::Instance().getContextPrompt(), tokens);
+		// job output and everything printed since the last prompt goes out at once
+		JobManager::Instance().flush(&console, console.output.stream());
+		console.output.flush();
+
+		bool result =  readLine(contextPrompt(), console.tokens);
 
 		if (!result)
 			continue;
 
+		BasicStringContainer_t& tokens = console.tokens;
+
 		if (tokens.empty())
 			continue;
 
@@ -239,15 +730,7 @@ void Engine::Run()
 		// context switching is very similar to the regular command
 		if (Engine::Instance().getContext() ==  CLI_CTX_NORMAL)
 		{
-			std::string result(""), spacer("");
-			/* in history only full command should be added */
-			for (size_t i = 0; i < tokens.size(); i++)
-			{
-				result += spacer + tokens[i];
-				spacer = " ";
-			}
-
-			if (result == "enable factory")
+			if (tokens.size() == 2 && tokens[0] == "enable" && tokens[1] == "factory")
 			{
 				if (hiddenCtxExecutor() == true)
 				{
@@ -259,225 +742,1069 @@ void Engine::Run()
 			}
 		}
 
-		Engine::CommandStorageTypeIterator_t begin, end, findIt;
-		begin =  CLI::Engine::commands().begin();
-		end =  CLI::Engine::commands().end();
-
-
-		if (tokens[CLI::tokens.size() -1 ]=="?" && tokens.size() > 1)
+		if (helpRequested(console))
 		{
-			CommandError_t  cmdError;
-			cmdError.position = tokens.begin();
-
-			tokens.erase(tokens.rbegin().base());
-
-			CLI::scopedLockSync lockGlobal( CLI::cliSync );
-
-			for_each(begin, end, ContextFunctor(CLI::tokens, cmdError));
-			copy(contextHelp.begin(), contextHelp.end(), std::ostream_iterator<string>(std::cout, "\n"));
+			printContextHelp(console);
 
 			char* pch = NULL;
 
 			pch = strchr(rl_line_buffer, '?');
 			if (pch != NULL)
-				cmdText.assign(rl_line_buffer, pch);
+				console.cmdText.assign(rl_line_buffer, pch);
 
 			rl_pre_input_hook = preinputhook;
 		}
 		else
 		{
-			CommandError_t  cmdError;
-			cmdError.position = tokens.begin();
-
 			rl_pre_input_hook = NULL;
 
-			CLI::scopedLockSync lockGlobal( CLI::cliSync );
+			// the line belongs to the context it was typed in
+			Context_t typed = Engine::Instance().getContext();
 
-			findIt = find_if (begin, end, LookupFunctor(CLI::tokens, cmdError));
-
-			if (findIt != end)
+			if (executeTokens(console))
 			{
-				std::string result(""), spacer("");
-				/* in history only full command should be added */
-				for (size_t i = 0; i < tokens.size(); i++)
-				{
-					result += spacer + tokens[i];
-					spacer = " ";
-				}
-				add_history(result.c_str());
-
-				findIt->second->execute(paramStorage, currentGroup.name());
+				if (readlineContext == typed)
+					add_history(consoleLine.c_str());
 
+				contextHistory(typed).append(consoleLine);
 			}
-			else
-			{
-				processErrorMsg(cmdError);
-			} // else
 		}
 	} // for
 
 }
 
-void  Engine::setContext (Context_t context)
+/*
+ * Executes command lines read from a stream, e.g. a provisioning script.
+ * Readline and history are bypassed and the exclusive execution lock
+ * is taken once for the whole batch. Empty lines and lines starting
+ * with '#' or '!' are skipped. Errors are reported with the line number
+ * and do not stop the batch. 'configure batch', 'commit' and 'abort'
+ * work as in a session; a batch the input leaves open is dropped.
+ *
+ * Returns the number of lines which failed.
+ */
+int Engine::RunBatch(std::istream& input)
 {
-	::clear_history();
-	context_ = context;
-}
+	std::string line;
+	size_t lineNumber = 0;
+	int failed = 0;
+	bool batchOpen = session->transaction.open();
 
-bool Engine::readLine(const std::string& prompt, BasicStringContainer_t& container)
-{
-	char * result = ::readline( prompt.c_str());
+	ExecutionLock lockExecution( CLI_ACCESS_EXCLUSIVE );
 
-	if ( result == NULL) return false;
+	while (!stop_to_work && std::getline(input, line))
+	{
+		++lineNumber;
 
-	if (*result == '\0') {
-		free (result);
-		return false;
-	}
+		{
+			StageTimer tokenize(CLI_STAGE_TOKENIZE);
 
-	std::string     line( result );
-	free( result );
+			lineTokenizer.split(line);
+			lineTokenizer.assign(session->tokens, session->filter);
+		}
 
-	boost::algorithm::trim( line );
+		const BasicStringContainer_t& tokens = session->tokens;
 
-	split_into_tokens_int(line, container);
+		if (tokens.empty() || tokens[0][0] == '#' || tokens[0][0] == '!')
+			continue;
 
-	return true;
+		Arena::Scope releaseArena( session->arena );
 
-}
+		// a script stages and commits configuration batches like a session does
+		bool internal;
+		bool rejected = false;
+		std::string reply;
 
-/*****************************************************************************/
-/*                          End CLI::Engine                                  */
-/*****************************************************************************/
+		{
+			OutputCapture capture( session->output.stream() );
 
-/*****************************************************************************/
-/*                           Local functions                                 */
-/*****************************************************************************/
+			internal = transactionCommand(session->transaction, tokens, &rejected);
+			reply = capture.text();
+		}
 
-namespace {
+		if (internal)
+		{
+			if (rejected)
+			{
+				session->output.stream() << "line " << lineNumber << ":\n";
+				++failed;
+			}
 
-int QuestionMarkKeyMap(int a, int b)
+			session->output.stream() << reply;
+			continue;
+		}
+
+		CommandError_t  cmdError;
+		cmdError.position = tokens.begin();
+
+		CommandInfoPtr_t info = lookupCommand(tokens, session->paramStorage, cmdError);
+
+		OutputFilter filter;
+
+		if (info && filter.parse(session->filter, cmdError))
+		{
+			runForeground(*session, *info, filter);
+		}
+		else
+		{
+			session->output.stream() << "line " << lineNumber << ":\n";
+			processErrorMsg(info ? session->filter : tokens, cmdError);
+			++failed;
+		}
+	}
+
+	// a batch the script did not commit is not left to the lines after it
+	if (session->transaction.open() && !batchOpen)
+	{
+		session->output.stream() << session->transaction.size() << " " << TR("changes dropped, the batch was not committed") << '\n';
+		session->transaction.abort();
+		++failed;
+	}
+
+	session->output.flush();
+
+	return failed;
+}
+
+/*
+ * Batch mode for "-f file"
+ */
+int Engine::RunBatch(const std::string& fileName)
 {
-	::rl_insert_text("?\n");
-	::rl_redisplay();
-	::rl_done = RL_STATE_DONE;
-	return 0;
+	std::ifstream input(fileName.c_str());
+
+	if (!input)
+	{
+		session->output.stream() << fileName << ": " << strerror(errno) << '\n';
+		session->output.flush();
+		return -1;
+	}
+
+	return RunBatch(input);
 }
 
-char ** UserCompletion( const char * text, int start, int end)
+/*
+ * Readline is given the history of the context the console enters,
+ * the history of the context left is put aside in memory
+ */
+void  Engine::setContext (Context_t context)
 {
-	// No default completion at all
-	rl_attempted_completion_over = 1;
+	if (session == &console && readlineHistoryLoaded && readlineContext != context)
+		switchReadlineHistory(context);
 
-	if ( CLI::Engine::commands().empty())
-		return NULL;
+	session->context = context;
+	context_ = context;
 
-	std::string     line(rl_line_buffer, end);
-	split_into_tokens_int(line, CLI::tokens);
-	return rl_completion_matches( text, Generator );
+	activeContext = &contextState(context);
+}
+
+bool Engine::readLine(const std::string& prompt, BasicStringContainer_t& container)
+{
+	char * result = ::readline( prompt.c_str());
+
+	if ( result == NULL) return false;
+
+	if (*result == '\0') {
+		free (result);
+		return false;
+	}
+
+	size_t length = strlen( result );
+	while (length > 0 && isspace(static_cast<unsigned char>(result[length - 1])))
+		--length;
+
+	consoleLine.assign(result, length);
+
+	recordLine(console, consoleLine);
+
+	{
+		StageTimer tokenize(CLI_STAGE_TOKENIZE);
+
+		lineTokenizer.split(result, length);
+		lineTokenizer.assign(container, console.filter);
+	}
+
+	free( result );
+
+	return true;
 
 }
 
-char * Generator(const char *  text, int  state )
+/*****************************************************************************/
+/*                          End CLI::Engine                                  */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                           Local functions                                 */
+/*****************************************************************************/
+
+namespace {
+
+/*
+ * State of the context, created when the context is first seen. Its
+ * commands are those of Engine::commands() while the engine is in it.
+ */
+ContextState& contextState(Context_t context)
 {
-	static CLI::Engine:: CommandStorageTypeIterator_t  Iterator;
-	static  int startWithIndex;
+	{
+		ReadLock_t lockRegistry( registrySync );
+
+		ContextStateType_t::iterator It = contextStates.find(context);
+
+		if (It != contextStates.end() && It->second.commands)
+			return It->second;
+	}
+
+	WriteLock_t lockRegistry( registrySync );
+
+	ContextState& state = contextStates[context];
+
+	if (!state.commands && context == CLI::Engine::Instance().getContext())
+		state.commands = &CLI::Engine::commands();
+
+	return state;
+}
+
+/*
+ * State of the context the engine is in
+ */
+ContextState& currentContext()
+{
+	if (!activeContext || !activeContext->commands)
+		activeContext = &contextState(CLI::Engine::Instance().getContext());
+
+	return *activeContext;
+}
+
+/*
+ * Prompt of the current context, asked from the engine once per line:
+ * it may show the host name or the configuration mode, which change
+ * without the context changing
+ */
+const std::string& contextPrompt()
+{
+	ContextState& state = currentContext();
+
+	state.prompt = CLI::Engine::Instance().getContextPrompt();
+
+	return state.prompt;
+}
+
+/*
+ * Snapshot of the index of the current context. Commands registered
+ * bypassing CLI::registerCommand are picked up by rebuilding it from
+ * Engine::commands(), which only changes under the write lock.
+ */
+CommandIndexPtr_t contextIndex()
+{
+	ContextState& state = currentContext();
 
-	if ( state == 0 )
 	{
-		startWithIndex = 0;
-		Iterator = CLI::Engine::commands().begin();
+		ReadLock_t lockRegistry( registrySync );
+
+		if (state.index && state.index->size() == state.commands->size())
+			return state.index;
 	}
-	for ( ; Iterator != CLI::Engine::commands().end(); ++Iterator )
+
+	WriteLock_t lockRegistry( registrySync );
+
+	PublishedIndexPtr_t& published = state.index;
+
+	if (!published || published->size() != state.commands->size())
 	{
-		bool get = strlen(text) > 0 ? false: true;
+		CommandIndex* index = new CommandIndex;
 
-		char*  result = static_cast<CommandPtr_t>(Iterator->second)->completion(get, CLI::tokens, startWithIndex);
-		if (result && startWithIndex)
+		Engine::CommandStorageTypeIterator_t It = state.commands->begin();
+		for (; It != state.commands->end(); ++It)
 		{
-			return result;
+			RegisteredCommandType_t::const_iterator infoIt = registeredCommands.find(It->second.get());
+
+			index->insert(infoIt != registeredCommands.end() ?
+					infoIt->second : commandInfo(It->second, CLI_ACCESS_EXCLUSIVE, NULL));
 		}
 
-		if (result)
+		published.reset(index);
+
+		helpCache.clear();
+	}
+
+	return published;
+}
+
+/*
+ * The line is matched against the index once, only commands whose
+ * keyword path matches the tokens are validated and the first one
+ * accepting the line wins.
+ */
+CommandInfoPtr_t lookupCommand(const BasicStringContainer_t& tokens, ParameterStorageType_t& paramStorage, CommandError_t& cmdError)
+{
+	StageTimer lookup(CLI_STAGE_LOOKUP);
+
+	CommandIndexPtr_t index = contextIndex();
+
+	CommandIndex::Match match( &session->arena );
+	index->match(tokens, tokens.size(), match, sessionGroups(*session));
+
+	const CommandIndex::CandidateContainer_t& candidates = match.commands();
+
+	// commands are given their keywords written out, error positions
+	// refer to the tokens as typed
+	CommandIndex::CandidateContainer_t::const_iterator findIt = candidates.begin();
+
+	for (; findIt != candidates.end(); ++findIt)
+	{
+		size_t depth = match.depth(findIt - candidates.begin());
+		const BasicStringContainer_t& line = expandKeywords(tokens, match, depth, session->expanded);
+
+		cmdError.position = line.begin() + (cmdError.position - tokens.begin());
+
+		bool accepted = LookupFunctor(line, paramStorage, cmdError)(*findIt);
+
+		cmdError.position = tokens.begin() + (cmdError.position - line.begin());
+
+		if (accepted)
+			break;
+	}
+
+	if (findIt != candidates.end())
+		return *findIt;
+
+	// keywords are known to be right up to the depth reached in the index
+	TokenConstIt_t reached = tokens.begin() + match.depth();
+
+	if (match.ambiguous() < match.depth())
+	{
+		// no command took the abbreviation, tell what it may stand for
+		CommandIndex::CompletionContainer_t keywords;
+		index->ambiguity(tokens, match, keywords);
+
+		cmdError.error = CLI_CMD_WRONG_KEYWORD;
+		cmdError.position = tokens.begin() + match.ambiguous();
+		cmdError.description.clear();
+
+		for (size_t i = 0; i < keywords.size(); ++i)
+			cmdError.description += (i > 0 ? ", " : "") + keywords[i];
+	}
+	else if (candidates.empty() || (cmdError.position < reached && (match.exhausted() || reached != tokens.end())))
+	{
+		cmdError.error = match.exhausted() ? CLI_CMD_SHORT : CLI_CMD_WRONG_KEYWORD;
+		cmdError.position = reached;
+		cmdError.description.clear();
+
+		// a mistyped keyword gets the keywords it was probably meant to be
+		if (cmdError.error == CLI_CMD_WRONG_KEYWORD && reached != tokens.end())
 		{
-			++Iterator;
-			startWithIndex = 0;
-			return result;
+			CommandIndex::CompletionContainer_t suggestions;
+			index->suggest(match, *reached, MAX_SUGGESTIONS, suggestions);
+
+			for (size_t i = 0; i < suggestions.size(); ++i)
+				cmdError.description += (i > 0 ? ", " : "") + suggestions[i];
 		}
+	}
+
+	Statistics::Instance().rejected();
+
+	return CommandInfoPtr_t();
+}
+
+/*
+ * Tokens with the first 'depth' ones written out as the keywords they
+ * abbreviate, for a command with that many keywords; the tokens after
+ * are its parameters and stay as typed. The tokens themselves if
+ * nothing was abbreviated.
+ */
+const BasicStringContainer_t& expandKeywords(const BasicStringContainer_t& tokens,
+		const CommandIndex::Match& match, size_t depth, BasicStringContainer_t& expanded)
+{
+	depth = std::min(depth, match.depth());
 
+	size_t first = 0;
+
+	for (; first < depth; ++first)
+	{
+		const std::string* keyword = match.keyword(first);
+
+		if (keyword != NULL && *keyword != tokens[first])
+			break;
+	}
+
+	if (first == depth)
+		return tokens;
+
+	expanded.resize(tokens.size());
+
+	for (size_t i = 0; i < tokens.size(); ++i)
+	{
+		const std::string* keyword = i < depth ? match.keyword(i) : NULL;
+		expanded[i].assign(keyword != NULL ? *keyword : tokens[i]);
 	}
 
-	return NULL;
+	return expanded;
 }
 
+/*
+ * Line ends with '?' following a command or a filter, the '?' is removed
+ */
+bool helpRequested(Session& target)
+{
+	BasicStringContainer_t& line = target.filter.empty() ? target.tokens : target.filter;
 
-void split_into_tokens_int (const std::string& stream, BasicStringContainer_t& array)
+	if (line.size() < 2 || line.back() != "?")
+		return false;
+
+	line.pop_back();
+	return true;
+}
+
+void printContextHelp(Session& target)
 {
+	if (!target.filter.empty())
+	{
+		OutputFilter::help(target.filter, target.contextHelp);
+	}
+	else
+		printCommandHelp(target);
 
-	std::string::const_iterator It = stream.begin();
-	std::string lexem;
+	std::ostream& out = target.output.stream();
 
-	array.clear();
+	for (BasicStringContainer_t::const_iterator It = target.contextHelp.begin(); It != target.contextHelp.end(); ++It)
+		out << *It << '\n';
+}
+
+/*
+ * Help is asked after nearly every word, so results are cached. Only
+ * commands reachable from the typed tokens are asked on a miss.
+ */
+void printCommandHelp(Session& target)
+{
+	GroupMask_t groups = sessionGroups(target);
+	std::string key = HelpCache::key(target.context, groups, target.tokens);
 
-	for ( ; It < stream.end(); ++It)
+	if (!helpCache.find(key, target.contextHelp))
 	{
+		unsigned generation = helpCache.generation();
+
+		CommandError_t  cmdError;
+		cmdError.position = target.tokens.begin();
+
+		Arena::Scope releaseArena( target.arena );
+
+		CommandIndexPtr_t index = contextIndex();
+
+		CommandIndex::Match match( &target.arena );
+		index->match(target.tokens, target.tokens.size(), match, groups);
+
+		CommandIndex::CandidateContainer_t reachable( match.commands().get_allocator() );
+		CommandIndex::DepthContainer_t depths( match.commands().get_allocator() );
+		index->reachable(match, reachable, &depths);
 
-		if  ( isspace(*It) || *It == '\n')
+		target.contextHelp.clear();
+
+		for (size_t i = 0; i < reachable.size(); ++i)
 		{
-			continue;
+			const BasicStringContainer_t& line = expandKeywords(target.tokens, match, depths[i], target.expanded);
+			cmdError.position = line.begin();
+
+			ContextFunctor(line, target, cmdError)(reachable[i]);
 		}
 
-		lexem.clear();
-		switch (*It)
+		helpCache.insert(key, target.contextHelp, generation);
+	}
+}
+
+/*
+ * Runs the command accepting the tokens of the session or reports
+ * why the line was rejected. The lookup works on a snapshot of the
+ * registry, only the execution is serialised as the command requires.
+ */
+bool executeTokens(Session& target)
+{
+	Arena::Scope releaseArena( target.arena );
+
+	// "<command> [| <filter>] &" runs in background
+	BasicStringContainer_t& line = target.filter.empty() ? target.tokens : target.filter;
+	bool background = line.size() > 1 && line.back() == "&";
+	if (background)
+		line.pop_back();
+
+	CommandError_t  cmdError;
+	cmdError.position = target.tokens.begin();
+
+	OutputFilter filter;
+
+	if (!filter.parse(target.filter, cmdError))
+	{
+		processErrorMsg(target.filter, cmdError);
+		return false;
+	}
+
+	{
+		OutputFilter::Scope filterOutput( target.output.stream(), filter );
+
+		bool failed = false;
+
+		if (jobCommand(&target, target.tokens, target.deferWait ? &target.waiting : NULL) ||
+				runTransactionCommand(target, &failed))
+			return !failed;
+
+		filterOutput.dismiss();
+	}
+
+	// the changes of a job could not be told from those of the batch
+	if (background && target.transaction.open())
+	{
+		target.output.stream() << TR("Background commands are not allowed in a configuration batch") << '\n';
+		return false;
+	}
+
+	if (lineTokenizer.ranged())
+	{
+		if (!fanOut(target, filter, background))
+			return false;
+
+		if (background)
+			line.push_back("&");
+		return true;
+	}
+
+	CommandInfoPtr_t info = lookupCommand(target.tokens, target.paramStorage, cmdError);
+
+	if (!info)
+	{
+		processErrorMsg(target.tokens, cmdError);
+		return false;
+	}
+
+	if (background)
+	{
+		startJob(target, info);
+		line.push_back("&");
+		return true;
+	}
+
+	ExecutionLock lockExecution( info->access );
+
+	runForeground(target, *info, filter);
+
+	return true;
+}
+
+/*
+ * 'configure batch', 'commit' and 'abort' of the session. The commit
+ * writes the configuration of every backend and holds the lock the
+ * whole time, as an exclusive command would.
+ */
+bool runTransactionCommand(Session& target, bool* failed)
+{
+	boost::optional<ExecutionLock> lockExecution;
+
+	if (commitsTransaction(target.transaction, target.tokens))
+		lockExecution = boost::in_place(CLI_ACCESS_EXCLUSIVE);
+
+	return transactionCommand(target.transaction, target.tokens, failed);
+}
+
+/*
+ * A line holding lists runs once per command it expands to. All of them
+ * are validated before any runs. Shared commands run concurrently on the
+ * job workers and their output is shown in the order of the expansion,
+ * the others run one after another under a single lock.
+ */
+bool fanOut(Session& target, OutputFilter& filter, bool background)
+{
+	std::vector<BasicStringContainer_t> lines;
+
+	if (!lineTokenizer.expand(target.tokens, MAX_FANOUT, lines))
+	{
+		target.output.stream() << TR("Too many commands in the lists, at most ") << MAX_FANOUT << '\n';
+		return false;
+	}
+
+	std::vector<Invocation> invocations(lines.size());
+	bool shared = true;
+
+	for (size_t i = 0; i < lines.size(); ++i)
+	{
+		CommandError_t cmdError;
+		cmdError.position = lines[i].begin();
+
+		invocations[i].info = lookupCommand(lines[i], invocations[i].paramStorage, cmdError);
+
+		if (!invocations[i].info)
 		{
-		case '"':
+			processErrorMsg(lines[i], cmdError);
+			return false;
+		}
+
+		shared = shared && invocations[i].info->access == CLI_ACCESS_SHARED;
+	}
+
+	if (background)
+	{
+		// one job per command, each listed and killed on its own
+		for (size_t i = 0; i < lines.size(); ++i)
 		{
-				++It;
-				size_t pos = stream.find('"', It - stream.begin());
+			target.tokens.swap(lines[i]);
+			target.paramStorage.swap(invocations[i].paramStorage);
 
-				if (pos != stream.npos)
-				{
-					std::string::const_iterator endIt = stream.begin();
-					advance(endIt, pos);
-					if (It != endIt)
-					{
-						lexem.assign(It, endIt);
-						boost::algorithm::trim(lexem);
-
-					}
-					It = stream.begin();
-					advance(It ,pos);
-					++It;
-				}
-				else
-				{
-					// here we willn't trim
-					lexem.assign(It, stream.end());
-					It = stream.end();
-				}
+			startJob(target, invocations[i].info);
+
+			target.tokens.swap(lines[i]);
+			target.paramStorage.swap(invocations[i].paramStorage);
 		}
-		break;
-		default:
-				while (It != stream.end())
-				{
-					if (!isspace(*It))
-					{
-						lexem.push_back(*It);
-						++It;
-					}
-					else
-					{
-						boost::algorithm::trim(lexem);
-						break;
-					}
 
-				}
+		return true;
+	}
+
+	target.output.flush();
+
+	std::string group = target.group.name();
+
+	OutputFilter::Scope filterOutput( target.output.stream(), filter );
+
+	// changes of a configuration batch are staged by the session's own thread
+	if (!shared || lines.size() == 1 || target.transaction.open())
+	{
+		ExecutionLock lockExecution( shared ? CLI_ACCESS_SHARED : CLI_ACCESS_EXCLUSIVE );
+
+		for (size_t i = 0; i < invocations.size(); ++i)
+			runCommand(*invocations[i].info, invocations[i].paramStorage, group);
+	}
+	else
+	{
+		// the jobs belong to the invocations, not to the jobs of the session
+		const void* owner = &invocations;
+		BasicStringContainer_t noFilter;
+
+		for (size_t i = 0; i < invocations.size(); ++i)
+		{
+			std::string text, spacer;
+			for (size_t j = 0; j < lines[i].size(); j++)
+			{
+				text += spacer + lines[i][j];
+				spacer = " ";
+			}
+
+			invocations[i].job = JobManager::Instance().submit(owner, text,
+					boost::bind(runJob, invocations[i].info, invocations[i].paramStorage, group, noFilter, _1));
 		}
 
-		array.push_back(lexem);
+		for (size_t i = 0; i < invocations.size(); ++i)
+		{
+			invocations[i].job->wait();
+			target.output.stream() << invocations[i].job->takeOutput();
+		}
+
+		JobManager::Instance().release(owner);
+	}
+
+	fflush(stdout);
+
+	return true;
+}
+
+/*
+ * Command output written to the session passes the filters of the line.
+ * Commands printing to stdout must not overtake the buffered output,
+ * what they print is not filtered.
+ */
+void runForeground(Session& target, const CommandInfo& info, OutputFilter& filter)
+{
+	target.output.flush();
+
+	{
+		OutputFilter::Scope filterOutput( target.output.stream(), filter );
+
+		runCommand(info, target.paramStorage, target.group.name());
+	}
+
+	fflush(stdout);
+}
+
+void runJob(const CommandInfoPtr_t& info, const ParameterStorageType_t& paramStorage,
+		const std::string& group, const BasicStringContainer_t& filterTokens, Job& job)
+{
+	// the filters were checked when the job was started
+	OutputFilter filter;
+	CommandError_t cmdError;
+	filter.parse(filterTokens, cmdError);
+
+	ExecutionLock lockExecution( info->access );
+
+	OutputFilter::Scope filterOutput( job.output(), filter );
+
+	runCommand(*info, paramStorage, group);
+}
+
+/*
+ * The job gets its own copy of the parameters and filters, the session
+ * goes on with the next line meanwhile
+ */
+void startJob(Session& target, const CommandInfoPtr_t& info)
+{
+	std::string text, spacer;
+	for (size_t i = 0; i < target.tokens.size(); i++)
+	{
+		text += spacer + target.tokens[i];
+		spacer = " ";
 	}
 
+	for (size_t i = 0; i < target.filter.size(); i++)
+		text += spacer + target.filter[i];
+
+	JobPtr_t job = JobManager::Instance().submit(&target, text,
+			boost::bind(runJob, info, target.paramStorage, target.group.name(), target.filter, _1));
+
+	target.output.stream() << "[" << job->id() << "] " << text << '\n';
+}
+
+/*
+ * The registry does not depend on the user any more, the snapshot is
+ * only bound to the build
+ */
+std::string snapshotIdentity(const std::string& build)
+{
+	return build;
+}
+
+/*
+ * Adds the command to the engine and publishes a new snapshot of the
+ * index of its context. The published index is changed in place while
+ * no lookup holds it.
+ */
+void publishCommand(const ModulePtr_t& module, const CommandPtr_t& command,
+		Context_t context, CommandAccess_t access, securityHook hook, const CachePolicy& cache)
+{
+	WriteLock_t lockRegistry( registrySync );
+
+	Engine::Instance().registerCommand(module, command, context);
+
+	PublishedIndexPtr_t& published = contextStates[context].index;
+
+	// nobody looks at the published index, e.g. while the modules start up
+	if (!published)
+		published.reset(new CommandIndex);
+	else if (!published.unique())
+		published.reset(new CommandIndex(*published));
+
+	CommandInfoPtr_t info = commandInfo(command, access, hook, cache);
+	registeredCommands[command.get()] = info;
+
+	published->insert(info);
+
+	helpCache.clear();
+}
+
+/*
+ * Registry entry of a command, with the counters of its keyword path and
+ * the groups seen so far which may use it
+ */
+CommandInfoPtr_t commandInfo(const CommandPtr_t& command, CommandAccess_t access, securityHook hook,
+		const CachePolicy& cache)
+{
+	BasicStringContainer_t path;
+	CommandIndex::keywordPath(command, path);
+
+	std::string name, spacer;
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		name += spacer + path[i];
+		spacer = " ";
+	}
+
+	CommandInfo* info = new CommandInfo(command, access, hook);
+	info->cache = cache;
+	info->statistics = Statistics::Instance().attach(command.get(), name.empty() ? "-" : name);
+
+	for (GroupBitType_t::const_iterator It = groupBits.begin(); hook && It != groupBits.end(); ++It)
+	{
+		if (hook(It->first))
+			info->groups.fetch_or(static_cast<GroupMask_t>(1) << It->second);
+	}
+
+	return CommandInfoPtr_t(info);
+}
+
+/*
+ * Bit of a user group. A group seen for the first time gets the next bit
+ * and the hooks of all registered commands are asked about it once.
+ * Groups beyond MAX_GROUPS get no bit and see no protected command.
+ */
+GroupMask_t groupMask(const std::string& group)
+{
+	{
+		ReadLock_t lockRegistry( registrySync );
+
+		GroupBitType_t::const_iterator It = groupBits.find(group);
+		if (It != groupBits.end())
+			return static_cast<GroupMask_t>(1) << It->second;
+	}
+
+	WriteLock_t lockRegistry( registrySync );
+
+	GroupBitType_t::const_iterator It = groupBits.find(group);
+	if (It != groupBits.end())
+		return static_cast<GroupMask_t>(1) << It->second;
+
+	if (groupBits.size() >= MAX_GROUPS)
+		return 0;
+
+	unsigned bit = groupBits.size();
+	groupBits[group] = bit;
+
+	GroupMask_t mask = static_cast<GroupMask_t>(1) << bit;
+
+	for (RegisteredCommandType_t::const_iterator infoIt = registeredCommands.begin(); infoIt != registeredCommands.end(); ++infoIt)
+	{
+		const CommandInfo& info = *infoIt->second;
+
+		if (info.hook && info.hook(group))
+			info.groups.fetch_or(mask);
+	}
+
+	for (ContextStateType_t::const_iterator stateIt = contextStates.begin(); stateIt != contextStates.end(); ++stateIt)
+		if (stateIt->second.index)
+			stateIt->second.index->refreshGroups();
+
+	return mask;
+}
+
+/*
+ * Groups of the session user, worked out again when the user changes.
+ * Root sees every command.
+ */
+GroupMask_t sessionGroups(Session& target)
+{
+	if (target.user.isRoot())
+		return CLI_GROUPS_ALL;
+
+	std::string group = target.group.name();
+
+	if (group != target.permissionsGroup || target.groups.size() != target.permissionsCount)
+	{
+		GroupMask_t permissions = groupMask(group);
+
+		for (BasicStringContainer_t::const_iterator It = target.groups.begin(); It != target.groups.end(); ++It)
+			permissions |= groupMask(*It);
+
+		target.permissions = permissions;
+		target.permissionsGroup = group;
+		target.permissionsCount = target.groups.size();
+	}
+
+	return target.permissions;
+}
+
+void runCommand(const CommandInfo& info, const ParameterStorageType_t& paramStorage, const std::string& group)
+{
+	boost::uint64_t start = Statistics::now();
+
+	// what a command stages in a batch changes nothing until the commit
+	ConfigTransaction* transaction = JobManager::current() ? NULL : &currentSession().transaction;
+	size_t staged = 0;
+
+	if (transaction && transaction->open())
+	{
+		staged = transaction->staged();
+		transaction->tagChanges(&info.cache.invalidates);
+	}
+	else
+		transaction = NULL;
+
+	if (info.cache.ttl)
+		runCached(info, paramStorage, group, start);
+	else
+		info.command->execute(paramStorage, group);
+
+	if (transaction)
+		transaction->tagChanges(NULL);
+
+	if (!transaction || transaction->staged() == staged)
+	{
+		for (BasicStringContainer_t::const_iterator It = info.cache.invalidates.begin(); It != info.cache.invalidates.end(); ++It)
+			ResultCache::Instance().invalidate(*It);
+	}
+
+	boost::uint64_t elapsed = Statistics::now() - start;
+
+	Statistics::Instance().record(CLI_STAGE_EXECUTE, elapsed);
+	if (info.statistics)
+		info.statistics->record(elapsed);
+}
+
+/*
+ * Output of the command for the parameters and group, reused while the
+ * time to live of the command is not over. Empty output is not kept.
+ */
+void runCached(const CommandInfo& info, const ParameterStorageType_t& paramStorage, const std::string& group,
+		boost::uint64_t now)
+{
+	ResultCache& results = ResultCache::Instance();
+
+	std::string key = ResultCache::key(info.command.get(), group, paramStorage);
+	std::string output;
+
+	if (!results.find(key, now, output))
+	{
+		unsigned generation = results.generation();
+
+		{
+			OutputCapture capture( commandOutput() );
+
+			info.command->execute(paramStorage, group);
+
+			output = capture.text();
+		}
+
+		// nothing written to commandOutput(): the command prints some other
+		// way, a hit would show nothing
+		if (!output.empty())
+			results.insert(key, output, now + info.cache.ttl * NS_PER_MS, info.cache.tags, generation);
+	}
+
+	commandOutput() << output;
+}
+
+void loadReadlineHistory(Context_t context)
+{
+	BasicStringContainer_t lines;
+	contextHistory(context).recent(READLINE_HISTORY_SIZE, lines);
+
+	::clear_history();
+
+	for (BasicStringContainer_t::const_iterator It = lines.begin(); It != lines.end(); ++It)
+		add_history(It->c_str());
+
+	readlineContext = context;
+	readlineHistoryLoaded = true;
+}
+
+/*
+ * Puts the readline history of the context left aside and gives readline
+ * the one of the context entered, read from its file on the first visit
+ */
+void switchReadlineHistory(Context_t context)
+{
+	contextState(readlineContext).history = ::history_get_history_state();
+
+	ContextState& entered = contextState(context);
+
+	if (entered.history)
+	{
+		::history_set_history_state(entered.history);
+		free(entered.history);
+		entered.history = NULL;
+
+		readlineContext = context;
+		return;
+	}
+
+	// the entries of the context left belong to its state now
+	HISTORY_STATE empty;
+	memset(&empty, 0, sizeof(empty));
+	::history_set_history_state(&empty);
+
+	loadReadlineHistory(context);
+}
+
+/*
+ * Ctrl-R replaces the line with the newest history line containing
+ * what was typed, pressing it again goes on to older matches. Without
+ * the history file or a match in it readline's own search takes over.
+ */
+int ReverseSearchKeyMap(int count, int key)
+{
+	static std::string pattern;
+	static std::string found;
+	static boost::uint64_t position = 0;
+
+	HistoryFile& history = contextHistory(CLI::Engine::Instance().getContext());
+
+	// readline's own search goes through the lines it holds, the file may not
+	if (!history.isOpen())
+		return ::rl_reverse_search_history(count, key);
+
+	std::string line(rl_line_buffer);
+
+	if (position == 0 || line != found)
+	{
+		pattern = line;
+		position = ~static_cast<boost::uint64_t>(0);
+	}
+
+	boost::uint64_t match = history.search(pattern, position, found);
+
+	if (match == 0)
+	{
+		position = 0;
+		return ::rl_reverse_search_history(count, key);
+	}
+
+	position = match;
+
+	::rl_replace_line(found.c_str(), 0);
+	rl_point = rl_end;
+	::rl_redisplay();
+
+	return 0;
+}
+
+int QuestionMarkKeyMap(int a, int b)
+{
+	::rl_insert_text("?\n");
+	::rl_redisplay();
+	::rl_done = RL_STATE_DONE;
+	return 0;
+}
+
+char ** UserCompletion( const char * text, int start, int end)
+{
+	// No default completion at all
+	rl_attempted_completion_over = 1;
+
+	if ( CLI::Engine::commands().empty())
+		return NULL;
+
+	lineTokenizer.split(rl_line_buffer, end);
+	lineTokenizer.assign(console.tokens);
+	return rl_completion_matches( text, Generator );
+
+}
+
+void CompletionCursor::reset(const BasicStringContainer_t& line, const char* text)
+{
+	std::string prefix(text);
+
+	// the word under the cursor is still being typed
+	size_t completed = line.size();
+	if (!prefix.empty() && completed > 0)
+		--completed;
+
+	CommandIndexPtr_t index = contextIndex();
+
+	CommandIndex::Match match;
+	index->match(line, completed, match, sessionGroups(console));
+	index->complete(match, line, prefix, matches_);
+	position_ = 0;
+}
+
+char * CompletionCursor::next()
+{
+	if (position_ >= matches_.size())
+		return NULL;
+
+	// readline takes ownership of the match
+	return strdup(matches_[position_++].c_str());
+}
+
+char * Generator(const char *  text, int  state )
+{
+	if ( state == 0 )
+	{
+		completionCursor.reset(console.tokens, text);
+	}
 
+	return completionCursor.next();
 }
 
 } // namespace
@@ -0,0 +1,302 @@
+/*
+ * cliFilter.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "cliFilter.h"
+
+namespace CLI {
+
+namespace {
+
+	const char PIPE[] = "|";
+
+	/* Token is a non empty abbreviation of the filter name */
+	bool abbreviates(const std::string& token, const char* name)
+	{
+		return !token.empty() && strncmp(token.c_str(), name, token.size()) == 0;
+	}
+
+} // namespace
+
+OutputFilter::OutputFilter() :
+	target_(NULL), failed_(0)
+{
+	setp(buffer_, buffer_ + BUFFER_SIZE);
+}
+
+bool OutputFilter::parse(const BasicStringContainer_t& tokens, CommandError_t& cmdError)
+{
+	stages_.clear();
+	failed_ = 0;
+	cmdError.description.clear();
+
+	BasicStringContainer_t::const_iterator It = tokens.begin();
+	BasicStringContainer_t::const_iterator end = tokens.end();
+
+	while (It != end)
+	{
+		// nothing may follow 'count'
+		if (!stages_.empty() && stages_.back().type == FILTER_COUNT)
+		{
+			cmdError.error = CLI_CMD_TOO_LONG;
+			cmdError.position = It;
+			return false;
+		}
+
+		++It;
+
+		if (It == end || *It == PIPE)
+		{
+			cmdError.error = CLI_CMD_SHORT;
+			cmdError.position = It;
+			return false;
+		}
+
+		Stage stage;
+		stage.started = false;
+		stage.count = 0;
+
+		if (abbreviates(*It, "include"))
+			stage.type = FILTER_INCLUDE;
+		else if (abbreviates(*It, "exclude"))
+			stage.type = FILTER_EXCLUDE;
+		else if (abbreviates(*It, "begin"))
+			stage.type = FILTER_BEGIN;
+		else if (abbreviates(*It, "count"))
+			stage.type = FILTER_COUNT;
+		else
+		{
+			cmdError.error = CLI_CMD_WRONG_KEYWORD;
+			cmdError.position = It;
+			return false;
+		}
+
+		// the expression is the rest of the stage, as typed
+		BasicStringContainer_t::const_iterator first = ++It;
+		std::string expression;
+
+		for (; It != end && *It != PIPE; ++It)
+		{
+			if (It != first)
+				expression += ' ';
+			expression += *It;
+		}
+
+		stage.any = expression.empty();
+
+		if (stage.any && stage.type != FILTER_COUNT)
+		{
+			cmdError.error = CLI_CMD_SHORT;
+			cmdError.position = It;
+			return false;
+		}
+
+		if (!stage.any)
+		{
+			try
+			{
+				stage.pattern.assign(expression, boost::regex::perl);
+			}
+			catch (const boost::regex_error&)
+			{
+				cmdError.error = CLI_CMD_WRONG_VALUE;
+				cmdError.position = first;
+				cmdError.description = TR("regular expression");
+				return false;
+			}
+		}
+
+		stages_.push_back(stage);
+	}
+
+	return true;
+}
+
+void OutputFilter::help(const BasicStringContainer_t& tokens, BasicStringContainer_t& lines)
+{
+	lines.clear();
+
+	// first token of the stage being typed
+	BasicStringContainer_t::const_iterator It = std::find(tokens.rbegin(), tokens.rend(), PIPE).base();
+
+	if (It == tokens.end())
+	{
+		lines.push_back(TR("begin     Begin with the line that matches"));
+		lines.push_back(TR("count     Count the lines"));
+		lines.push_back(TR("exclude   Exclude lines that match"));
+		lines.push_back(TR("include   Include lines that match"));
+		return;
+	}
+
+	bool count = abbreviates(*It, "count");
+
+	if (!count && !abbreviates(*It, "include") && !abbreviates(*It, "exclude") && !abbreviates(*It, "begin"))
+		return;
+
+	lines.push_back(TR("LINE      Regular expression"));
+
+	if (count || It + 1 != tokens.end())
+		lines.push_back("<cr>");
+}
+
+OutputFilter::int_type OutputFilter::overflow(int_type c)
+{
+	process();
+
+	if (!traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+
+	return traits_type::not_eof(c);
+}
+
+int OutputFilter::sync()
+{
+	process();
+
+	return target_->pubsync();
+}
+
+void OutputFilter::process()
+{
+	const char* It = pbase();
+	const char* end = pptr();
+
+	for (;;)
+	{
+		const char* newline = static_cast<const char*>(memchr(It, '\n', end - It));
+
+		if (newline == NULL)
+			break;
+
+		if (line_.empty())
+			filter(It, newline, true);
+		else
+		{
+			line_.append(It, newline);
+			filter(line_.data(), line_.data() + line_.size(), true);
+			line_.clear();
+		}
+
+		It = newline + 1;
+	}
+
+	line_.append(It, end);
+
+	setp(buffer_, buffer_ + BUFFER_SIZE);
+}
+
+/*
+ * An expression too complex for the line throws, which must neither end
+ * the session output nor escape Scope's destructor: the line is taken as
+ * not matching and finish() tells how many lines that happened to.
+ */
+bool OutputFilter::search(const boost::regex& pattern, const char* begin, const char* end)
+{
+	try
+	{
+		return boost::regex_search(begin, end, pattern);
+	}
+	catch (const std::runtime_error&)
+	{
+		++failed_;
+		return false;
+	}
+}
+
+bool OutputFilter::filter(const char* begin, const char* end, bool newline)
+{
+	for (StageContainer_t::iterator It = stages_.begin(); It != stages_.end(); ++It)
+	{
+		bool matches = It->any || search(It->pattern, begin, end);
+
+		switch (It->type)
+		{
+		case FILTER_INCLUDE:
+			if (!matches)
+				return false;
+			break;
+		case FILTER_EXCLUDE:
+			if (matches)
+				return false;
+			break;
+		case FILTER_BEGIN:
+			if (!It->started && !matches)
+				return false;
+			It->started = true;
+			break;
+		case FILTER_COUNT:
+			if (matches)
+				++It->count;
+			return false;
+		}
+	}
+
+	target_->sputn(begin, end - begin);
+
+	if (newline)
+		target_->sputc('\n');
+
+	return true;
+}
+
+void OutputFilter::finish()
+{
+	process();
+
+	// an incomplete last line the notice below must not run into
+	bool open = false;
+
+	if (!line_.empty())
+	{
+		open = filter(line_.data(), line_.data() + line_.size(), false);
+		line_.clear();
+	}
+
+	std::ostream out(target_);
+
+	if (stages_.back().type == FILTER_COUNT)
+		out << TR("Number of lines") << ": " << stages_.back().count << '\n';
+
+	if (failed_)
+		out << (open ? "\n" : "") << TR("Expression too complex, lines taken as not matching") << ": " << failed_ << '\n';
+}
+
+OutputFilter::Scope::Scope(std::ostream& out, OutputFilter& filter) :
+	out_(out), filter_(filter), target_(out.rdbuf()), active_(!filter.empty())
+{
+	if (active_)
+	{
+		filter_.target_ = target_;
+		out_.rdbuf(&filter_);
+	}
+}
+
+OutputFilter::Scope::~Scope()
+{
+	if (active_)
+	{
+		filter_.finish();
+		out_.rdbuf(target_);
+	}
+}
+
+void OutputFilter::Scope::dismiss()
+{
+	if (active_)
+	{
+		out_.rdbuf(target_);
+		active_ = false;
+	}
+}
+
+} // CLI
@@ -0,0 +1,124 @@
+/*
+ * cliFilter.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIFILTER_H_
+#define CLIFILTER_H_
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <boost/regex.hpp>
+
+#include "cliApi.h"
+#include "cliCommand.h"
+
+namespace CLI {
+
+	/*
+	 * Filters typed after '|' at the end of a command line:
+	 *
+	 *   | include <regex>    lines matching the expression
+	 *   | exclude <regex>    lines not matching it
+	 *   | begin <regex>      everything from the first matching line on
+	 *   | count [<regex>]    only the number of (matching) lines
+	 *
+	 * Filters may be chained, 'count' has to be the last one. Names may be
+	 * abbreviated. Expressions are compiled once when the line is parsed.
+	 * A line an expression is too complex to match is taken as not
+	 * matching, the output ends with the number of such lines.
+	 *
+	 * The filter sits between the command and the session output as a
+	 * stream buffer. Output is filtered line by line as it is written,
+	 * only a line not yet complete is kept, so huge outputs are never held
+	 * in memory and lines dropped never reach the terminal.
+	 */
+	class OutputFilter : public std::streambuf
+	{
+		public:
+			enum { BUFFER_SIZE = 4096 };
+
+			OutputFilter();
+
+			/*
+			 * Builds the chain from the tokens starting with the first '|'.
+			 * On error cmdError refers to the offending token.
+			 */
+			bool parse(const BasicStringContainer_t& tokens, CommandError_t& cmdError);
+
+			bool empty() const { return stages_.empty(); }
+
+			/* Context help for the filter being typed, tokens start with the first '|' */
+			static void help(const BasicStringContainer_t& tokens, BasicStringContainer_t& lines);
+
+			/* Filters the output written to 'out' for the life time of the object */
+			class Scope
+			{
+				public:
+					Scope(std::ostream& out, OutputFilter& filter);
+					~Scope();
+
+					/* Nothing was written, the filter is removed without output */
+					void dismiss();
+
+				private:
+					Scope(const Scope&);
+					Scope& operator=(const Scope&);
+
+					std::ostream&   out_;
+					OutputFilter&   filter_;
+					std::streambuf* target_;
+					bool            active_;
+			};
+
+		protected:
+			int_type overflow(int_type c);
+			int sync();
+
+		private:
+			enum StageType_t
+			{
+				FILTER_INCLUDE,
+				FILTER_EXCLUDE,
+				FILTER_BEGIN,
+				FILTER_COUNT
+			};
+
+			struct Stage
+			{
+				StageType_t  type;
+				bool         any;       // no expression, 'count' only
+				boost::regex pattern;
+				bool         started;   // 'begin' has seen its line
+				size_t       count;
+			};
+
+			typedef std::vector<Stage> StageContainer_t;
+
+			OutputFilter(const OutputFilter&);
+			OutputFilter& operator=(const OutputFilter&);
+
+			/* Passes the complete lines of the buffer through the chain */
+			void process();
+			/* False if the line was dropped */
+			bool filter(const char* begin, const char* end, bool newline);
+			bool search(const boost::regex& pattern, const char* begin, const char* end);
+
+			/* Sends the last incomplete line and the counts downstream */
+			void finish();
+
+			StageContainer_t stages_;
+			std::streambuf*  target_;
+			std::string      line_;     // incomplete line
+			size_t           failed_;   // matches the expression was too complex for
+			char             buffer_[BUFFER_SIZE];
+	};
+
+} // CLI
+
+#endif /* CLIFILTER_H_ */
@@ -0,0 +1,95 @@
+/*
+ * cliHelpCache.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <sstream>
+
+#include "cliHelpCache.h"
+
+namespace CLI {
+
+namespace {
+
+	/* Can not appear in a token */
+	const char KEY_SEPARATOR = '\n';
+
+} // namespace
+
+HelpCache::HelpCache(size_t capacity) :
+	capacity_(capacity), generation_(0)
+{
+}
+
+std::string HelpCache::key(Context_t context, GroupMask_t groups,
+		const BasicStringContainer_t& tokens)
+{
+	std::ostringstream result;
+
+	result << static_cast<int>(context) << KEY_SEPARATOR << std::hex << groups;
+
+	for (BasicStringContainer_t::const_iterator It = tokens.begin(); It != tokens.end(); ++It)
+		result << KEY_SEPARATOR << *It;
+
+	return result.str();
+}
+
+bool HelpCache::find(const std::string& key, BasicStringContainer_t& help)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	EntryIndexType_t::iterator It = index_.find(key);
+
+	if (It == index_.end())
+		return false;
+
+	entries_.splice(entries_.begin(), entries_, It->second);
+	help = It->second->second;
+
+	return true;
+}
+
+unsigned HelpCache::generation()
+{
+	boost::mutex::scoped_lock lock(sync_);
+	return generation_;
+}
+
+void HelpCache::insert(const std::string& key, const BasicStringContainer_t& help, unsigned generation)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	if (generation != generation_)
+		return;
+
+	EntryIndexType_t::iterator It = index_.find(key);
+
+	if (It != index_.end())
+	{
+		It->second->second = help;
+		entries_.splice(entries_.begin(), entries_, It->second);
+		return;
+	}
+
+	entries_.push_front(EntryType_t(key, help));
+	index_[key] = entries_.begin();
+
+	if (entries_.size() > capacity_)
+	{
+		index_.erase(entries_.back().first);
+		entries_.pop_back();
+	}
+}
+
+void HelpCache::clear()
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	entries_.clear();
+	index_.clear();
+	++generation_;
+}
+
+} // CLI
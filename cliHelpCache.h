@@ -0,0 +1,62 @@
+/*
+ * cliHelpCache.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIHELPCACHE_H_
+#define CLIHELPCACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <boost/thread/mutex.hpp>
+
+#include "cliApi.h"
+#include "cliCommandIndex.h"
+
+namespace CLI {
+
+	/*
+	 * Least recently used cache of context help. The key is built from the
+	 * context, the user groups and the tokens typed before '?'.
+	 */
+	class HelpCache
+	{
+		public:
+			explicit HelpCache(size_t capacity);
+
+			static std::string key(Context_t context, GroupMask_t groups,
+					const BasicStringContainer_t& tokens);
+
+			bool find(const std::string& key, BasicStringContainer_t& help);
+
+			/*
+			 * Help computed while generation() returned 'generation' is
+			 * dropped if the cache was cleared in the meantime
+			 */
+			void insert(const std::string& key, const BasicStringContainer_t& help, unsigned generation);
+
+			unsigned generation();
+
+			/* Forgets everything, called when the registry changes */
+			void clear();
+
+		private:
+			typedef std::pair<std::string, BasicStringContainer_t> EntryType_t;
+			typedef std::list<EntryType_t>                         EntryStorageType_t;
+			typedef std::map<std::string, EntryStorageType_t::iterator> EntryIndexType_t;
+
+			const size_t       capacity_;
+			unsigned           generation_;
+			EntryStorageType_t entries_;   // most recently used first
+			EntryIndexType_t   index_;
+			boost::mutex       sync_;
+	};
+
+} // CLI
+
+#endif /* CLIHELPCACHE_H_ */
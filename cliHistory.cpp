@@ -0,0 +1,495 @@
+/*
+ * cliHistory.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <boost/shared_ptr.hpp>
+
+#include "cliHistory.h"
+
+namespace CLI {
+
+namespace {
+
+	const boost::uint32_t HISTORY_MAGIC = 0x48494c43;   // "CLIH"
+	const boost::uint32_t HISTORY_VERSION = 1;
+
+	const char* HISTORY_DIRECTORY_ENV = "CLI_HISTORY_DIR";
+
+	/* Suffix of a file of another layout moved out of the way */
+	const char* HISTORY_ASIDE_SUFFIX = ".old";
+
+	/* Opens of a history file renamed by another process meanwhile */
+	const int OPEN_ATTEMPTS = 3;
+
+	/* Holds flock on the history file, other processes append to it too */
+	class FileLock
+	{
+		public:
+			explicit FileLock(int fd) : fd_(fd)
+			{
+				while (::flock(fd_, LOCK_EX) < 0 && errno == EINTR)
+					;
+			}
+
+			~FileLock()
+			{
+				::flock(fd_, LOCK_UN);
+			}
+
+		private:
+			int fd_;
+	};
+
+	/* FNV-1a */
+	boost::uint64_t lineHash(const std::string& line)
+	{
+		boost::uint64_t result = 14695981039346656037ULL;
+
+		for (std::string::const_iterator It = line.begin(); It != line.end(); ++It)
+		{
+			result ^= static_cast<unsigned char>(*It);
+			result *= 1099511628211ULL;
+		}
+
+		return result;
+	}
+
+	boost::uint32_t trigram(const char* text)
+	{
+		return static_cast<boost::uint32_t>(static_cast<unsigned char>(text[0])) << 16 |
+				static_cast<boost::uint32_t>(static_cast<unsigned char>(text[1])) << 8 |
+				static_cast<unsigned char>(text[2]);
+	}
+
+	/* Empty if the history is not to be kept in a file */
+	std::string defaultDirectory()
+	{
+		const char* directory = getenv(HISTORY_DIRECTORY_ENV);
+		if (directory != NULL)
+			return directory;
+
+		const char* home = getenv("HOME");
+		if (home != NULL && *home != '\0')
+			return std::string(home) + "/.cli_history";
+
+		return std::string();
+	}
+
+	typedef boost::shared_ptr<HistoryFile>        HistoryFilePtr_t;
+	typedef std::map<Context_t, HistoryFilePtr_t> ContextHistoryType_t;
+
+	boost::mutex         historySync;
+	ContextHistoryType_t histories;
+	std::string          historyDirectory = defaultDirectory();
+
+} // namespace
+
+/* First slot of the file */
+struct HistoryFile::Header
+{
+	boost::uint32_t magic;
+	boost::uint32_t version;
+	boost::uint32_t slotSize;
+	boost::uint32_t capacity;
+	boost::uint64_t next;       // sequence number of the next line
+};
+
+/*
+ * The sequence number is 0 while the slot is being written, readers
+ * check it before and after copying the line
+ */
+struct HistoryFile::Slot
+{
+	enum { TEXT_SIZE = SLOT_SIZE - 16 };
+
+	boost::uint64_t sequence;
+	boost::uint16_t length;
+	boost::uint8_t  dead;
+	boost::uint8_t  reserved[5];
+	char            text[TEXT_SIZE];
+};
+
+HistoryFile::HistoryFile() :
+	fd_(-1), header_(NULL), slots_(NULL), capacity_(0), mapped_(0), indexed_(1), pruned_(0)
+{
+}
+
+HistoryFile::~HistoryFile()
+{
+	close();
+}
+
+bool HistoryFile::open(const std::string& path, size_t capacity)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	if (header_ != NULL || capacity == 0)
+		return false;
+
+	for (int attempt = 0; attempt < OPEN_ATTEMPTS && fd_ < 0; ++attempt)
+	{
+		int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+		if (fd < 0)
+			return false;
+
+		Layout_t layout;
+
+		{
+			FileLock lockFile(fd);
+			layout = prepare(fd, path, capacity);
+		}
+
+		if (layout == LAYOUT_READY)
+			fd_ = fd;
+		else
+		{
+			::close(fd);
+
+			if (layout == LAYOUT_REFUSED)
+				return false;
+		}
+	}
+
+	if (fd_ < 0)
+		return false;
+
+	size_t size = (capacity + 1) * SLOT_SIZE;
+
+	void* mapping = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+	if (mapping == MAP_FAILED)
+	{
+		::close(fd_);
+		fd_ = -1;
+		return false;
+	}
+
+	header_ = static_cast<Header*>(mapping);
+	slots_ = reinterpret_cast<Slot*>(static_cast<char*>(mapping) + SLOT_SIZE);
+	capacity_ = capacity;
+	mapped_ = size;
+	indexed_ = 1;
+	pruned_ = 0;
+
+	refresh();
+
+	return true;
+}
+
+/*
+ * The file is never truncated: one of another layout may be anything,
+ * it is renamed aside and a new one is created
+ */
+HistoryFile::Layout_t HistoryFile::prepare(int fd, const std::string& path, size_t capacity)
+{
+	size_t size = (capacity + 1) * SLOT_SIZE;
+
+	struct stat st;
+	struct stat current;
+	Header header;
+
+	// lines typed by the user go to a plain file of the user only
+	if (::fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_uid != ::geteuid())
+		return LAYOUT_REFUSED;
+
+	// renamed aside by another process while waiting for the lock
+	if (::lstat(path.c_str(), &current) < 0 || current.st_dev != st.st_dev || current.st_ino != st.st_ino)
+		return LAYOUT_RETRY;
+
+	if (static_cast<size_t>(st.st_size) == size &&
+			::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+			header.magic == HISTORY_MAGIC && header.version == HISTORY_VERSION &&
+			header.slotSize == SLOT_SIZE && header.capacity == static_cast<boost::uint32_t>(capacity))
+		return LAYOUT_READY;
+
+	if (st.st_size != 0)
+	{
+		std::string aside = path + HISTORY_ASIDE_SUFFIX;
+		return ::rename(path.c_str(), aside.c_str()) == 0 ? LAYOUT_RETRY : LAYOUT_REFUSED;
+	}
+
+	// growing a new file zeroes every slot without touching the pages
+	header.magic = HISTORY_MAGIC;
+	header.version = HISTORY_VERSION;
+	header.slotSize = SLOT_SIZE;
+	header.capacity = capacity;
+	header.next = 1;
+
+	if (::ftruncate(fd, size) < 0 ||
+			::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+		return LAYOUT_REFUSED;
+
+	return LAYOUT_READY;
+}
+
+void HistoryFile::close()
+{
+	if (header_ != NULL)
+		::munmap(header_, mapped_);
+
+	if (fd_ >= 0)
+		::close(fd_);
+
+	fd_ = -1;
+	header_ = NULL;
+	slots_ = NULL;
+	trigrams_.clear();
+	lines_.clear();
+}
+
+boost::uint64_t HistoryFile::next() const
+{
+	return __atomic_load_n(&header_->next, __ATOMIC_ACQUIRE);
+}
+
+boost::uint64_t HistoryFile::oldest() const
+{
+	boost::uint64_t last = next();
+	return last > capacity_ ? last - capacity_ : 1;
+}
+
+bool HistoryFile::read(boost::uint64_t sequence, std::string& line) const
+{
+	const Slot& slot = slots_[(sequence - 1) % capacity_];
+
+	if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) != sequence)
+		return false;
+
+	size_t length = std::min<size_t>(slot.length, Slot::TEXT_SIZE);
+	bool dead = slot.dead != 0;
+	line.assign(slot.text, length);
+
+	// the slot may have been reused while it was copied
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return !dead && __atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+void HistoryFile::index(boost::uint64_t sequence, const std::string& line)
+{
+	lines_[lineHash(line)] = sequence;
+
+	for (size_t i = 0; i + 3 <= line.size(); ++i)
+	{
+		PostingType_t& posting = trigrams_[trigram(line.data() + i)];
+
+		if (posting.empty() || posting.back() != sequence)
+			posting.push_back(sequence);
+	}
+}
+
+/* Drops the sequence numbers overwritten in the ring */
+void HistoryFile::prune()
+{
+	boost::uint64_t first = oldest();
+
+	for (TrigramIndexType_t::iterator It = trigrams_.begin(); It != trigrams_.end(); )
+	{
+		PostingType_t& posting = It->second;
+		posting.erase(posting.begin(), std::lower_bound(posting.begin(), posting.end(), first));
+
+		if (posting.empty())
+			It = trigrams_.erase(It);
+		else
+			++It;
+	}
+
+	for (LineIndexType_t::iterator It = lines_.begin(); It != lines_.end(); )
+	{
+		if (It->second < first)
+			It = lines_.erase(It);
+		else
+			++It;
+	}
+
+	pruned_ = first;
+}
+
+void HistoryFile::refresh()
+{
+	boost::uint64_t last = next();
+
+	// the file was reset by another process
+	if (last < indexed_)
+	{
+		trigrams_.clear();
+		lines_.clear();
+		indexed_ = 1;
+		pruned_ = 0;
+	}
+
+	for (boost::uint64_t sequence = std::max(indexed_, oldest()); sequence < last; ++sequence)
+	{
+		if (read(sequence, scratch_))
+			index(sequence, scratch_);
+	}
+
+	indexed_ = last;
+
+	if (oldest() > pruned_ + capacity_ / 4)
+		prune();
+}
+
+void HistoryFile::append(const std::string& line)
+{
+	if (line.empty() || line.size() > Slot::TEXT_SIZE)
+		return;
+
+	boost::mutex::scoped_lock lock(sync_);
+
+	if (header_ == NULL)
+		return;
+
+	FileLock lockFile(fd_);
+
+	refresh();
+
+	boost::uint64_t sequence = header_->next;
+
+	LineIndexType_t::const_iterator It = lines_.find(lineHash(line));
+
+	if (It != lines_.end() && read(It->second, scratch_) && scratch_ == line)
+	{
+		// already the last one
+		if (It->second + 1 == sequence)
+			return;
+
+		__atomic_store_n(&slots_[(It->second - 1) % capacity_].dead, 1, __ATOMIC_RELEASE);
+	}
+
+	Slot& slot = slots_[(sequence - 1) % capacity_];
+
+	__atomic_store_n(&slot.sequence, 0, __ATOMIC_RELAXED);
+	// readers must not see the new text before the cleared sequence number
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(slot.text, line.data(), line.size());
+	slot.length = line.size();
+	slot.dead = 0;
+	__atomic_store_n(&slot.sequence, sequence, __ATOMIC_RELEASE);
+
+	__atomic_store_n(&header_->next, sequence + 1, __ATOMIC_RELEASE);
+
+	index(sequence, line);
+	indexed_ = sequence + 1;
+}
+
+void HistoryFile::recent(size_t count, BasicStringContainer_t& lines)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	if (header_ == NULL)
+		return;
+
+	refresh();
+
+	boost::uint64_t last = next();
+	boost::uint64_t first = std::max(oldest(), last > count ? last - count : 1);
+
+	std::string line;
+	for (boost::uint64_t sequence = first; sequence < last; ++sequence)
+	{
+		if (read(sequence, line))
+			lines.push_back(line);
+	}
+}
+
+boost::uint64_t HistoryFile::search(const std::string& pattern, boost::uint64_t before, std::string& line)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	if (header_ == NULL)
+		return 0;
+
+	refresh();
+
+	boost::uint64_t first = oldest();
+	before = std::min(before, next());
+
+	// too short for the index, recent lines are the likely match anyway
+	if (pattern.size() < 3)
+	{
+		for (boost::uint64_t sequence = before; sequence-- > first; )
+		{
+			if (read(sequence, line) && line.find(pattern) != std::string::npos)
+				return sequence;
+		}
+
+		return 0;
+	}
+
+	// the rarest trigram of the pattern gives the fewest candidates
+	const PostingType_t* candidates = NULL;
+
+	for (size_t i = 0; i + 3 <= pattern.size(); ++i)
+	{
+		TrigramIndexType_t::const_iterator It = trigrams_.find(trigram(pattern.data() + i));
+
+		if (It == trigrams_.end())
+			return 0;
+
+		if (candidates == NULL || It->second.size() < candidates->size())
+			candidates = &It->second;
+	}
+
+	PostingType_t::const_iterator It = std::lower_bound(candidates->begin(), candidates->end(), before);
+
+	while (It != candidates->begin())
+	{
+		boost::uint64_t sequence = *--It;
+
+		if (sequence < first)
+			break;
+
+		if (read(sequence, line) && line.find(pattern) != std::string::npos)
+			return sequence;
+	}
+
+	return 0;
+}
+
+void setHistoryDirectory(const std::string& directory)
+{
+	boost::mutex::scoped_lock lock(historySync);
+	historyDirectory = directory;
+}
+
+HistoryFile& contextHistory(Context_t context)
+{
+	boost::mutex::scoped_lock lock(historySync);
+
+	HistoryFilePtr_t& result = histories[context];
+
+	if (!result)
+	{
+		result.reset(new HistoryFile);
+
+		if (historyDirectory.empty())
+			return *result;
+
+		::mkdir(historyDirectory.c_str(), 0700);
+
+		std::ostringstream path;
+		path << historyDirectory << "/context" << static_cast<int>(context) << ".history";
+
+		// without a file the context simply has no persistent history
+		result->open(path.str());
+	}
+
+	return *result;
+}
+
+} // CLI
@@ -0,0 +1,131 @@
+/*
+ * cliHistory.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIHISTORY_H_
+#define CLIHISTORY_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "cliApi.h"
+
+namespace CLI {
+
+	/*
+	 * Command history of one context kept in a memory mapped ring file.
+	 *
+	 * The file holds a header and a ring of fixed size slots, the line with
+	 * sequence number N lives in slot (N - 1) % capacity. Every process and
+	 * session working in the context appends to the same file under flock,
+	 * the others pick the new lines up on their next access. A line entered
+	 * again is moved to the top: its older copy is marked dead.
+	 *
+	 * Reverse search goes through a trigram index of the live lines built
+	 * in memory, only slots holding all trigrams of the pattern are read.
+	 * Lines longer than a slot are not kept. Nothing is kept without the
+	 * file: the engine's Ctrl-R then uses readline's incremental search
+	 * over the lines of the session, as it does when the file has no match.
+	 */
+	class HistoryFile
+	{
+		public:
+			enum
+			{
+				SLOT_SIZE        = 256,
+				DEFAULT_CAPACITY = 65536
+			};
+
+			HistoryFile();
+			~HistoryFile();
+
+			/*
+			 * Maps the file, creating it with mode 0600 if it is missing.
+			 * A file of another layout is renamed aside to "<path>.old",
+			 * symbolic links and files of other users are refused.
+			 */
+			bool open(const std::string& path, size_t capacity = DEFAULT_CAPACITY);
+			void close();
+
+			bool isOpen() const { return header_ != NULL; }
+
+			void append(const std::string& line);
+
+			/* Up to 'count' most recent lines, oldest first */
+			void recent(size_t count, BasicStringContainer_t& lines);
+
+			/*
+			 * Newest line containing 'pattern' with a sequence number below
+			 * 'before'. Returns its sequence number, 0 if nothing matches.
+			 */
+			boost::uint64_t search(const std::string& pattern, boost::uint64_t before, std::string& line);
+
+		private:
+			struct Header;
+			struct Slot;
+
+			enum Layout_t
+			{
+				LAYOUT_READY,
+				LAYOUT_RETRY,     // the file at the path changed, open it again
+				LAYOUT_REFUSED
+			};
+
+			typedef std::vector<boost::uint64_t>                            PostingType_t;
+			typedef boost::unordered_map<boost::uint32_t, PostingType_t>    TrigramIndexType_t;
+			typedef boost::unordered_map<boost::uint64_t, boost::uint64_t>  LineIndexType_t;
+
+			HistoryFile(const HistoryFile&);
+			HistoryFile& operator=(const HistoryFile&);
+
+			/* Checks the locked file, laying out an empty one */
+			Layout_t prepare(int fd, const std::string& path, size_t capacity);
+
+			boost::uint64_t next() const;
+			boost::uint64_t oldest() const;
+
+			/* Copies the live line of a sequence number, false if it is gone */
+			bool read(boost::uint64_t sequence, std::string& line) const;
+
+			/* Indexes the lines appended since the last call */
+			void refresh();
+			void index(boost::uint64_t sequence, const std::string& line);
+			void prune();
+
+			int                fd_;
+			Header*            header_;
+			Slot*              slots_;
+			size_t             capacity_;
+			size_t             mapped_;
+
+			boost::uint64_t    indexed_;   // next sequence number to index
+			boost::uint64_t    pruned_;    // oldest sequence number at the last prune
+			TrigramIndexType_t trigrams_;
+			LineIndexType_t    lines_;     // line hash -> newest sequence number
+			std::string        scratch_;   // line read from a slot
+
+			boost::mutex       sync_;
+	};
+
+	/*
+	 * Directory of the history files, by default $CLI_HISTORY_DIR or
+	 * ~/.cli_history. An empty directory, also CLI_HISTORY_DIR set to an
+	 * empty value, keeps typed lines out of any file. Contexts opened
+	 * before the change keep their file.
+	 */
+	void setHistoryDirectory(const std::string& directory);
+
+	/* History of a context, opened on first use */
+	HistoryFile& contextHistory(Context_t context);
+
+} // CLI
+
+#endif /* CLIHISTORY_H_ */
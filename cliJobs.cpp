@@ -0,0 +1,379 @@
+/*
+ * cliJobs.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <iostream>
+#include <stdlib.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "cliJobs.h"
+#include "cliSession.h"
+
+namespace CLI {
+
+namespace {
+
+	const unsigned MIN_WORKERS = 2;
+	const unsigned MAX_WORKERS = 8;
+
+	/* Job of the worker thread, not owned */
+	void noCleanup(Job*) {}
+	boost::thread_specific_ptr<Job> runningJob(noCleanup);
+
+	std::string stateName(Job::State_t state)
+	{
+		switch (state)
+		{
+		case Job::JOB_QUEUED:
+			return TR("Queued");
+		case Job::JOB_RUNNING:
+			return TR("Running");
+		case Job::JOB_DONE:
+			return TR("Done");
+		case Job::JOB_KILLED:
+			return TR("Killed");
+		default:
+			return std::string();
+		}
+	}
+
+	/* Job id made of digits only, no sign or blanks */
+	bool parseJobId(const std::string& token, unsigned& id)
+	{
+		if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos)
+			return false;
+
+		id = static_cast<unsigned>(strtoul(token.c_str(), NULL, 10));
+		return true;
+	}
+
+} // namespace
+
+/*****************************************************************************/
+/*                               CLI::Job                                    */
+/*****************************************************************************/
+Job::Job(unsigned id, const void* owner, const std::string& text, const Task_t& task) :
+	id_(id), owner_(owner), text_(text), task_(task), state_(JOB_QUEUED), cancelled_(false)
+{
+}
+
+Job::State_t Job::state() const
+{
+	boost::mutex::scoped_lock lock(sync_);
+	return state_;
+}
+
+bool Job::finished() const
+{
+	State_t current = state();
+	return current == JOB_DONE || current == JOB_KILLED;
+}
+
+bool Job::cancelled() const
+{
+	boost::mutex::scoped_lock lock(sync_);
+	return cancelled_;
+}
+
+std::string Job::takeOutput()
+{
+	// the task writes without locking, output is taken once it is over
+	if (!finished())
+		return std::string();
+
+	std::string result = output_.str();
+	output_.str(std::string());
+
+	return result;
+}
+
+void Job::wait()
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	while (state_ == JOB_QUEUED || state_ == JOB_RUNNING)
+		done_.wait(lock);
+}
+
+void Job::run()
+{
+	{
+		boost::mutex::scoped_lock lock(sync_);
+
+		if (cancelled_)
+			return;
+
+		state_ = JOB_RUNNING;
+	}
+
+	runningJob.reset(this);
+
+	try
+	{
+		task_(*this);
+	}
+	catch (const std::exception& e)
+	{
+		output_ << e.what() << std::endl;
+	}
+
+	runningJob.reset();
+
+	boost::mutex::scoped_lock lock(sync_);
+
+	state_ = cancelled_ ? JOB_KILLED : JOB_DONE;
+	done_.notify_all();
+}
+
+void Job::cancel()
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	cancelled_ = true;
+
+	// a queued job never starts, a running one stops at its next check
+	if (state_ == JOB_QUEUED)
+	{
+		state_ = JOB_KILLED;
+		done_.notify_all();
+	}
+}
+
+/*****************************************************************************/
+/*                            CLI::JobManager                                */
+/*****************************************************************************/
+JobManager& JobManager::Instance()
+{
+	static JobManager manager;
+	return manager;
+}
+
+JobManager::JobManager() :
+	nextId_(1), stop_(false)
+{
+	unsigned count = boost::thread::hardware_concurrency();
+
+	count = std::max(MIN_WORKERS, std::min(MAX_WORKERS, count));
+
+	for (unsigned i = 0; i < count; ++i)
+		workers_.create_thread(boost::bind(&JobManager::worker, this));
+}
+
+JobManager::~JobManager()
+{
+	{
+		boost::mutex::scoped_lock lock(sync_);
+
+		stop_ = true;
+		for (JobStorageType_t::iterator It = jobs_.begin(); It != jobs_.end(); ++It)
+			(*It)->cancel();
+	}
+
+	wakeup_.notify_all();
+	workers_.join_all();
+}
+
+void JobManager::worker()
+{
+	for (;;)
+	{
+		JobPtr_t job;
+
+		{
+			boost::mutex::scoped_lock lock(sync_);
+
+			while (queue_.empty() && !stop_)
+				wakeup_.wait(lock);
+
+			if (stop_)
+				return;
+
+			job = queue_.front();
+			queue_.pop_front();
+		}
+
+		job->run();
+	}
+}
+
+JobPtr_t JobManager::submit(const void* owner, const std::string& text, const Job::Task_t& task)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	JobPtr_t job(new Job(nextId_++, owner, text, task));
+
+	jobs_.push_back(job);
+	queue_.push_back(job);
+
+	wakeup_.notify_one();
+
+	return job;
+}
+
+JobPtr_t JobManager::find(const void* owner, unsigned id) const
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	for (JobStorageType_t::const_iterator It = jobs_.begin(); It != jobs_.end(); ++It)
+	{
+		if ((*It)->owner() == owner && (*It)->id() == id)
+			return *It;
+	}
+
+	return JobPtr_t();
+}
+
+bool JobManager::kill(const void* owner, unsigned id)
+{
+	JobPtr_t job = find(owner, id);
+
+	if (!job)
+		return false;
+
+	job->cancel();
+	return true;
+}
+
+void JobManager::jobs(const void* owner, std::vector<JobPtr_t>& result) const
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	result.clear();
+	for (JobStorageType_t::const_iterator It = jobs_.begin(); It != jobs_.end(); ++It)
+	{
+		if ((*It)->owner() == owner)
+			result.push_back(*It);
+	}
+}
+
+void JobManager::flush(const void* owner, std::ostream& out)
+{
+	std::vector<JobPtr_t> finished;
+
+	{
+		boost::mutex::scoped_lock lock(sync_);
+
+		JobStorageType_t::iterator It = jobs_.begin();
+		while (It != jobs_.end())
+		{
+			if ((*It)->owner() == owner && (*It)->finished())
+			{
+				finished.push_back(*It);
+				It = jobs_.erase(It);
+			}
+			else
+				++It;
+		}
+	}
+
+	for (std::vector<JobPtr_t>::iterator It = finished.begin(); It != finished.end(); ++It)
+	{
+		out << (*It)->takeOutput();
+		out << "[" << (*It)->id() << "] " << stateName((*It)->state()) << "    " << (*It)->text() << '\n';
+	}
+}
+
+void JobManager::release(const void* owner)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	JobStorageType_t::iterator It = jobs_.begin();
+	while (It != jobs_.end())
+	{
+		if ((*It)->owner() == owner)
+		{
+			(*It)->cancel();
+			It = jobs_.erase(It);
+		}
+		else
+			++It;
+	}
+}
+
+Job* JobManager::current()
+{
+	return runningJob.get();
+}
+
+/*****************************************************************************/
+/*                               Functions                                   */
+/*****************************************************************************/
+JobPtr_t runAsync(const std::string& text, const Job::Task_t& task)
+{
+	return JobManager::Instance().submit(&currentSession(), text, task);
+}
+
+std::ostream& commandOutput()
+{
+	Job* job = JobManager::current();
+
+	return job != NULL ? job->output() : currentSession().output.stream();
+}
+
+bool jobCommand(const void* owner, const BasicStringContainer_t& tokens, JobPtr_t* waiting)
+{
+	if (tokens.empty())
+		return false;
+
+	JobManager& manager = JobManager::Instance();
+	const std::string& name = tokens[0];
+	std::ostream& out = commandOutput();
+
+	if (name == "jobs" && tokens.size() == 1)
+	{
+		std::vector<JobPtr_t> jobs;
+		manager.jobs(owner, jobs);
+
+		for (std::vector<JobPtr_t>::const_iterator It = jobs.begin(); It != jobs.end(); ++It)
+			out << "[" << (*It)->id() << "] " << stateName((*It)->state()) << "    " << (*It)->text() << '\n';
+
+		return true;
+	}
+
+	// other lines starting with these words are left to registered commands
+	unsigned id = 0;
+	JobPtr_t job;
+
+	if (name == "fg" && tokens.size() == 1)
+	{
+		std::vector<JobPtr_t> jobs;
+		manager.jobs(owner, jobs);
+
+		if (!jobs.empty())
+		{
+			job = jobs.back();
+			id = job->id();
+		}
+	}
+	else if ((name == "fg" || name == "kill") && tokens.size() == 2 && parseJobId(tokens[1], id))
+		job = manager.find(owner, id);
+	else
+		return false;
+
+	if (!job)
+	{
+		out << name << ": " << TR("No such job") << '\n';
+		return true;
+	}
+
+	if (name == "kill")
+		manager.kill(owner, id);
+	else if (waiting)
+	{
+		*waiting = job;
+		return true;
+	}
+	else
+		job->wait();
+
+	manager.flush(owner, out);
+
+	return true;
+}
+
+} // CLI
@@ -0,0 +1,152 @@
+/*
+ * cliJobs.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIJOBS_H_
+#define CLIJOBS_H_
+
+#include <deque>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "cliApi.h"
+
+namespace CLI {
+
+	class Job;
+	typedef boost::shared_ptr<Job> JobPtr_t;
+
+	/*
+	 * Command line running on the worker pool. Output written to output()
+	 * is kept until the owner session reaches its next prompt.
+	 */
+	class Job
+	{
+		public:
+			typedef boost::function<void (Job&)> Task_t;
+
+			enum State_t
+			{
+				JOB_QUEUED,
+				JOB_RUNNING,
+				JOB_DONE,
+				JOB_KILLED
+			};
+
+			Job(unsigned id, const void* owner, const std::string& text, const Task_t& task);
+
+			unsigned id() const { return id_; }
+			const void* owner() const { return owner_; }
+			const std::string& text() const { return text_; }
+
+			State_t state() const;
+			bool finished() const;
+
+			/* Set by 'kill', long running tasks should check it and return */
+			bool cancelled() const;
+
+			/* Job output, valid only from inside the task */
+			std::ostream& output() { return output_; }
+
+			/* Takes the output produced since the last call */
+			std::string takeOutput();
+
+			/* Blocks until the task returns or the job is killed */
+			void wait();
+
+		private:
+			friend class JobManager;
+
+			void run();
+			void cancel();
+
+			const unsigned     id_;
+			const void*        owner_;
+			const std::string  text_;
+			Task_t             task_;
+
+			State_t            state_;
+			bool               cancelled_;
+			std::ostringstream output_;
+
+			mutable boost::mutex      sync_;
+			boost::condition_variable done_;
+	};
+
+	/*
+	 * Worker pool running jobs of all sessions. Jobs are identified by
+	 * a number, their owner is an opaque pointer to the session which
+	 * started them.
+	 */
+	class JobManager
+	{
+		public:
+			static JobManager& Instance();
+
+			JobPtr_t submit(const void* owner, const std::string& text, const Job::Task_t& task);
+
+			JobPtr_t find(const void* owner, unsigned id) const;
+			bool kill(const void* owner, unsigned id);
+
+			/* Jobs of the owner, oldest first */
+			void jobs(const void* owner, std::vector<JobPtr_t>& result) const;
+
+			/*
+			 * Writes buffered output and completion notices of the owner's jobs,
+			 * finished jobs are forgotten afterwards
+			 */
+			void flush(const void* owner, std::ostream& out);
+
+			/* Kills and forgets all jobs of an owner which goes away */
+			void release(const void* owner);
+
+			/* Job the calling thread is running, NULL outside the pool */
+			static Job* current();
+
+		private:
+			JobManager();
+			~JobManager();
+
+			void worker();
+
+			typedef std::list<JobPtr_t>  JobStorageType_t;
+			typedef std::deque<JobPtr_t> JobQueueType_t;
+
+			mutable boost::mutex      sync_;
+			boost::condition_variable wakeup_;
+			JobStorageType_t          jobs_;
+			JobQueueType_t            queue_;
+			boost::thread_group       workers_;
+			unsigned                  nextId_;
+			bool                      stop_;
+	};
+
+	/* Runs task in background on behalf of the current session */
+	JobPtr_t runAsync(const std::string& text, const Job::Task_t& task);
+
+	/* Stream for command output: the job buffer inside a job, the session output otherwise */
+	std::ostream& commandOutput();
+
+	/*
+	 * Internal 'jobs', 'fg [<id>]' and 'kill <id>' commands of the session,
+	 * 'fg' alone takes the latest job. Given 'waiting', 'fg' does not block
+	 * but leaves the job there, its output comes with the owner's flush
+	 * once it finished. Returns false if tokens are not exactly one of
+	 * these, other lines are left to registered commands.
+	 */
+	bool jobCommand(const void* owner, const BasicStringContainer_t& tokens, JobPtr_t* waiting = NULL);
+
+} // CLI
+
+#endif /* CLIJOBS_H_ */
@@ -0,0 +1,122 @@
+/*
+ * cliKeywordTree.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <algorithm>
+
+#include "cliKeywordTree.h"
+
+namespace CLI {
+
+namespace {
+
+	typedef std::pair<unsigned, std::string> CandidateType_t;
+
+	struct EdgeDistance
+	{
+		bool operator()(const std::pair<unsigned, size_t>& edge, unsigned distance) const
+		{
+			return edge.first < distance;
+		}
+	};
+
+} // namespace
+
+unsigned KeywordTree::distance(const std::string& left, const std::string& right)
+{
+	// single row of the dynamic programming table
+	std::vector<unsigned> row(right.size() + 1);
+
+	for (size_t j = 0; j <= right.size(); ++j)
+		row[j] = j;
+
+	for (size_t i = 1; i <= left.size(); ++i)
+	{
+		unsigned diagonal = row[0];
+		row[0] = i;
+
+		for (size_t j = 1; j <= right.size(); ++j)
+		{
+			unsigned above = row[j];
+			unsigned cost = left[i - 1] == right[j - 1] ? 0 : 1;
+
+			row[j] = std::min(std::min(row[j] + 1, row[j - 1] + 1), diagonal + cost);
+			diagonal = above;
+		}
+	}
+
+	return row[right.size()];
+}
+
+void KeywordTree::insert(const std::string& word)
+{
+	Vertex vertex;
+	vertex.word = word;
+
+	if (vertices_.empty())
+	{
+		vertices_.push_back(vertex);
+		return;
+	}
+
+	size_t current = 0;
+
+	for (;;)
+	{
+		unsigned d = distance(word, vertices_[current].word);
+
+		if (d == 0)
+			return;
+
+		EdgeContainer_t& edges = vertices_[current].edges;
+		EdgeContainer_t::iterator It = std::lower_bound(edges.begin(), edges.end(), d, EdgeDistance());
+
+		if (It == edges.end() || It->first != d)
+		{
+			edges.insert(It, std::make_pair(d, vertices_.size()));
+			vertices_.push_back(vertex);
+			return;
+		}
+
+		current = It->second;
+	}
+}
+
+void KeywordTree::find(const std::string& word, unsigned limit, BasicStringContainer_t& found) const
+{
+	found.clear();
+
+	if (vertices_.empty())
+		return;
+
+	std::vector<CandidateType_t> candidates;
+	std::vector<size_t> pending(1, 0);
+
+	while (!pending.empty())
+	{
+		const Vertex& vertex = vertices_[pending.back()];
+		pending.pop_back();
+
+		unsigned d = distance(word, vertex.word);
+
+		if (d <= limit)
+			candidates.push_back(CandidateType_t(d, vertex.word));
+
+		unsigned low = d > limit ? d - limit : 0;
+
+		EdgeContainer_t::const_iterator It = std::lower_bound(vertex.edges.begin(), vertex.edges.end(), low, EdgeDistance());
+
+		for (; It != vertex.edges.end() && It->first <= d + limit; ++It)
+			pending.push_back(It->second);
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	for (std::vector<CandidateType_t>::const_iterator It = candidates.begin(); It != candidates.end(); ++It)
+		found.push_back(It->second);
+}
+
+} // CLI
@@ -0,0 +1,57 @@
+/*
+ * cliKeywordTree.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIKEYWORDTREE_H_
+#define CLIKEYWORDTREE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cliApi.h"
+
+namespace CLI {
+
+	/*
+	 * BK-tree of keywords under the edit distance (Levenshtein).
+	 *
+	 * Every word hangs below its parent at the edge labelled with their
+	 * distance. By the triangle inequality a search for words within 'n'
+	 * edits only has to descend edges labelled d - n .. d + n, where d is
+	 * the distance to the vertex visited, so a lookup touches a small part
+	 * of a large vocabulary.
+	 */
+	class KeywordTree
+	{
+		public:
+			KeywordTree() {}
+
+			void insert(const std::string& word);
+
+			size_t size() const { return vertices_.size(); }
+			bool empty() const { return vertices_.empty(); }
+
+			/* Words within 'distance' edits of 'word', closest first, then sorted */
+			void find(const std::string& word, unsigned distance, BasicStringContainer_t& found) const;
+
+			static unsigned distance(const std::string& left, const std::string& right);
+
+		private:
+			typedef std::vector<std::pair<unsigned, size_t> > EdgeContainer_t;
+
+			struct Vertex
+			{
+				std::string     word;
+				EdgeContainer_t edges;   // distance -> vertex
+			};
+
+			std::vector<Vertex> vertices_;
+	};
+
+} // CLI
+
+#endif /* CLIKEYWORDTREE_H_ */
@@ -0,0 +1,210 @@
+/*
+ * cliOutput.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <sys/uio.h>
+
+#include "cliOutput.h"
+
+namespace CLI {
+
+namespace {
+
+	const char BLANKS[] = "                                                                ";
+
+	/*
+	 * Writes all pieces, retrying after signals and short writes. What a
+	 * non-blocking descriptor does not take goes to the backlog.
+	 */
+	bool writeAll(int fd, struct iovec* pieces, int count, std::string& backlog)
+	{
+		while (count > 0)
+		{
+			ssize_t written = ::writev(fd, pieces, count);
+
+			if (written < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+					return false;
+
+				for (; count > 0; ++pieces, --count)
+					backlog.append(static_cast<const char*>(pieces->iov_base), pieces->iov_len);
+
+				return true;
+			}
+
+			while (count > 0 && static_cast<size_t>(written) >= pieces->iov_len)
+			{
+				written -= pieces->iov_len;
+				++pieces;
+				--count;
+			}
+
+			if (count > 0)
+			{
+				pieces->iov_base = static_cast<char*>(pieces->iov_base) + written;
+				pieces->iov_len -= written;
+			}
+		}
+
+		return true;
+	}
+
+} // namespace
+
+OutputSink::OutputSink(int fd, size_t capacity) :
+	fd_(fd), buffer_(capacity), stream_(this)
+{
+	reset();
+}
+
+OutputSink::~OutputSink()
+{
+	flush();
+}
+
+OutputSink::OutputSink(const OutputSink& other) :
+	std::streambuf(), fd_(other.fd_), buffer_(other.buffer_.size()), stream_(this)
+{
+	reset();
+}
+
+OutputSink& OutputSink::operator=(const OutputSink& other)
+{
+	if (this != &other)
+	{
+		flush();
+		backlog_.clear();
+		fd_ = other.fd_;
+	}
+
+	return *this;
+}
+
+void OutputSink::setDescriptor(int fd)
+{
+	flush();
+	backlog_.clear();
+	fd_ = fd;
+}
+
+bool OutputSink::flush(const char* tail, size_t length)
+{
+	struct iovec pieces[2];
+	int count = 0;
+
+	if (pending() > 0)
+	{
+		pieces[count].iov_base = pbase();
+		pieces[count].iov_len = pending();
+		++count;
+	}
+
+	if (length > 0)
+	{
+		pieces[count].iov_base = const_cast<char*>(tail);
+		pieces[count].iov_len = length;
+		++count;
+	}
+
+	reset();
+
+	// nothing may overtake the backlog, drain() sends it when the descriptor is ready
+	if (!backlog_.empty())
+	{
+		for (int i = 0; i < count; ++i)
+			backlog_.append(static_cast<const char*>(pieces[i].iov_base), pieces[i].iov_len);
+
+		return true;
+	}
+
+	return writeAll(fd_, pieces, count, backlog_);
+}
+
+bool OutputSink::drain()
+{
+	size_t sent = 0;
+
+	while (sent < backlog_.size())
+	{
+		ssize_t written = ::write(fd_, backlog_.data() + sent, backlog_.size() - sent);
+
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				return false;
+
+			break;
+		}
+
+		sent += written;
+	}
+
+	backlog_.erase(0, sent);
+
+	return true;
+}
+
+void OutputSink::pad(size_t count)
+{
+	while (count > 0)
+	{
+		size_t chunk = count < sizeof(BLANKS) - 1 ? count : sizeof(BLANKS) - 1;
+
+		sputn(BLANKS, chunk);
+		count -= chunk;
+	}
+}
+
+OutputSink::int_type OutputSink::overflow(int_type c)
+{
+	if (!flush())
+		return traits_type::eof();
+
+	if (!traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+
+	return traits_type::not_eof(c);
+}
+
+/*
+ * Text which does not fit any more is written together with the
+ * buffer, without copying it first
+ */
+std::streamsize OutputSink::xsputn(const char* data, std::streamsize count)
+{
+	if (count <= epptr() - pptr())
+	{
+		memcpy(pptr(), data, count);
+		pbump(count);
+		return count;
+	}
+
+	return flush(data, count) ? count : 0;
+}
+
+int OutputSink::sync()
+{
+	return flush() ? 0 : -1;
+}
+
+void OutputSink::reset()
+{
+	setp(&buffer_[0], &buffer_[0] + buffer_.size());
+}
+
+} // CLI
@@ -0,0 +1,81 @@
+/*
+ * cliOutput.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIOUTPUT_H_
+#define CLIOUTPUT_H_
+
+#include <stddef.h>
+#include <unistd.h>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace CLI {
+
+	/*
+	 * Output of a session to its terminal or peer.
+	 *
+	 * Text is collected in a buffer and written once the session reaches
+	 * its prompt, or earlier when the buffer is full. A flush is a single
+	 * writev of the buffer and whatever is to follow it, e.g. the prompt,
+	 * so a prompt cycle costs one system call instead of one per printf.
+	 *
+	 * std::endl flushes the sink, engine code ends lines with '\n'.
+	 *
+	 * A non-blocking descriptor may take only part of a flush, the rest
+	 * and everything flushed after it is kept in order as the backlog
+	 * until drain() gets it out.
+	 */
+	class OutputSink : public std::streambuf
+	{
+		public:
+			enum { DEFAULT_CAPACITY = 16 * 1024 };
+
+			explicit OutputSink(int fd = STDOUT_FILENO, size_t capacity = DEFAULT_CAPACITY);
+			~OutputSink();
+
+			/* A copy starts empty and writes to the same descriptor */
+			OutputSink(const OutputSink& other);
+			OutputSink& operator=(const OutputSink& other);
+
+			std::ostream& stream() { return stream_; }
+
+			int descriptor() const { return fd_; }
+			void setDescriptor(int fd);
+
+			size_t pending() const { return pptr() - pbase(); }
+
+			/* Writes the buffered text followed by 'tail', false on a write error */
+			bool flush(const char* tail = NULL, size_t length = 0);
+
+			/* Text the descriptor did not take yet */
+			size_t backlog() const { return backlog_.size(); }
+
+			/* Writes as much of the backlog as the descriptor takes, false on a write error */
+			bool drain();
+
+			/* Writes 'count' blanks */
+			void pad(size_t count);
+
+		protected:
+			int_type overflow(int_type c);
+			std::streamsize xsputn(const char* data, std::streamsize count);
+			int sync();
+
+		private:
+			void reset();
+
+			int               fd_;
+			std::vector<char> buffer_;
+			std::string       backlog_;
+			std::ostream      stream_;
+	};
+
+} // CLI
+
+#endif /* CLIOUTPUT_H_ */
@@ -0,0 +1,179 @@
+/*
+ * cliPrefixTrie.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIPREFIXTRIE_H_
+#define CLIPREFIXTRIE_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+namespace CLI {
+
+	/*
+	 * Character trie over the keywords of one grammar node, each keyword
+	 * with a value. Finding what a token abbreviates costs one step per
+	 * character of the token, whatever the number of keywords: the vertex
+	 * it spells knows how many keywords start there and which one when it
+	 * is the only one.
+	 */
+	template <class T>
+	class PrefixTrie
+	{
+		public:
+			typedef boost::uint32_t Index_t;
+
+			static const Index_t NONE = ~static_cast<Index_t>(0);
+
+			PrefixTrie() : vertices_(1) {}
+
+			/* Adds a keyword or changes its value */
+			void set(const std::string& word, const T& value)
+			{
+				Index_t vertex = 0;
+
+				for (std::string::const_iterator It = word.begin(); It != word.end(); ++It)
+					vertex = child(vertex, *It);
+
+				if (vertices_[vertex].word != NONE)
+				{
+					values_[vertices_[vertex].word] = value;
+					return;
+				}
+
+				Index_t index = words_.size();
+				words_.push_back(word);
+				values_.push_back(value);
+				vertices_[vertex].word = index;
+
+				// every vertex on the path leads to one more keyword
+				vertex = 0;
+				for (std::string::const_iterator It = word.begin(); ; ++It)
+				{
+					++vertices_[vertex].count;
+					vertices_[vertex].last = index;
+
+					if (It == word.end())
+						break;
+
+					vertex = find(vertex, *It);
+				}
+			}
+
+			/* Vertex spelled by the token, NONE if no keyword starts with it */
+			Index_t find(const std::string& token) const
+			{
+				Index_t vertex = 0;
+
+				for (std::string::const_iterator It = token.begin(); It != token.end() && vertex != NONE; ++It)
+					vertex = find(vertex, *It);
+
+				return vertex;
+			}
+
+			/* Keywords starting with the vertex */
+			Index_t count(Index_t vertex) const { return vertices_[vertex].count; }
+
+			/* Keyword the vertex spells, NONE if it is only a prefix */
+			Index_t exact(Index_t vertex) const { return vertices_[vertex].word; }
+
+			/* Keyword the vertex abbreviates, NONE if there are several */
+			Index_t unique(Index_t vertex) const
+			{
+				const Vertex& found = vertices_[vertex];
+
+				if (found.word != NONE)
+					return found.word;
+
+				return found.count == 1 ? found.last : NONE;
+			}
+
+			/* Calls visitor with every keyword starting with the vertex, in order */
+			template <class Visitor>
+			void visit(Index_t vertex, Visitor& visitor) const
+			{
+				const Vertex& current = vertices_[vertex];
+
+				if (current.word != NONE)
+					visitor(current.word);
+
+				for (Index_t It = current.child; It != NONE; It = vertices_[It].sibling)
+					visit(It, visitor);
+			}
+
+			const std::string& word(Index_t index) const { return words_[index]; }
+			const T& value(Index_t index) const { return values_[index]; }
+
+		private:
+			/*
+			 * Vertices live in one array, the children of a vertex form a list
+			 * sorted by character. A keyword node has few distinct characters
+			 * at each position, so the lists are short and a lookup stays
+			 * within a few cache lines.
+			 */
+			struct Vertex
+			{
+				explicit Vertex(char c = 0) :
+					character(c), child(NONE), sibling(NONE), word(NONE), count(0), last(NONE)
+				{}
+
+				char    character;
+				Index_t child;     // first child
+				Index_t sibling;   // next child of the parent
+				Index_t word;      // keyword ending here
+				Index_t count;     // keywords below
+				Index_t last;      // one of them
+			};
+
+			static bool before(char left, char right)
+			{
+				return static_cast<unsigned char>(left) < static_cast<unsigned char>(right);
+			}
+
+			Index_t find(Index_t vertex, char c) const
+			{
+				Index_t It = vertices_[vertex].child;
+
+				while (It != NONE && before(vertices_[It].character, c))
+					It = vertices_[It].sibling;
+
+				return It != NONE && vertices_[It].character == c ? It : NONE;
+			}
+
+			Index_t child(Index_t vertex, char c)
+			{
+				Index_t* link = &vertices_[vertex].child;
+
+				while (*link != NONE && before(vertices_[*link].character, c))
+					link = &vertices_[*link].sibling;
+
+				if (*link != NONE && vertices_[*link].character == c)
+					return *link;
+
+				Index_t found = vertices_.size();
+				Index_t next = *link;
+
+				// the link points into the array which is about to grow
+				*link = found;
+				vertices_.push_back(Vertex(c));
+				vertices_[found].sibling = next;
+
+				return found;
+			}
+
+			std::vector<Vertex>      vertices_;
+			std::vector<std::string> words_;
+			std::vector<T>           values_;
+	};
+
+	template <class T>
+	const typename PrefixTrie<T>::Index_t PrefixTrie<T>::NONE;
+
+} // CLI
+
+#endif /* CLIPREFIXTRIE_H_ */
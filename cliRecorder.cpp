@@ -0,0 +1,280 @@
+/*
+ * cliRecorder.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cliJobs.h"
+#include "cliRecorder.h"
+#include "cliSession.h"
+#include "cliStatistics.h"
+
+namespace CLI {
+
+namespace {
+
+	const boost::uint64_t NS_PER_US = 1000;
+	const boost::uint64_t NS_PER_S = 1000000000;
+
+	/* Shown in the report, in percent */
+	const double PERCENTILES[] = { 50, 90, 99, 99.9 };
+
+	FILE* recording = NULL;
+	boost::uint64_t recordingStart = 0;
+	boost::mutex recordingSync;
+
+	/* Checked without the lock on every line */
+	boost::atomic<bool> recordingActive(false);
+
+	struct Record
+	{
+		boost::uint64_t time;   // us
+		unsigned        session;
+		std::string     line;
+	};
+
+	/* Stable by time, lines of a session keep their order */
+	bool earlier(const Record& first, const Record& second)
+	{
+		return first.time < second.time;
+	}
+
+	bool loadRecording(const std::string& path, std::vector<Record>& records)
+	{
+		std::ifstream input(path.c_str());
+
+		if (!input)
+			return false;
+
+		std::string text;
+
+		while (std::getline(input, text))
+		{
+			std::string::size_type first = text.find('\t');
+			std::string::size_type second = first == std::string::npos ? first : text.find('\t', first + 1);
+
+			// a record cut short by a crash of the recording process
+			if (second == std::string::npos)
+				continue;
+
+			Record record;
+			record.time = strtoull(text.c_str(), NULL, 10);
+			record.session = strtoul(text.c_str() + first + 1, NULL, 10);
+			record.line.assign(text, second + 1, std::string::npos);
+
+			records.push_back(record);
+		}
+
+		std::stable_sort(records.begin(), records.end(), earlier);
+
+		return true;
+	}
+
+	void sleepUntil(boost::uint64_t deadline)
+	{
+		boost::uint64_t now = Statistics::now();
+
+		if (now >= deadline)
+			return;
+
+		struct timespec delay;
+		delay.tv_sec = (deadline - now) / NS_PER_S;
+		delay.tv_nsec = (deadline - now) % NS_PER_S;
+
+		nanosleep(&delay, NULL);
+	}
+
+	void printPercentiles(const char* title, const std::vector<boost::uint64_t>& sorted, std::ostream& out)
+	{
+		out << std::setw(10) << title;
+
+		for (size_t i = 0; i < sizeof(PERCENTILES) / sizeof(PERCENTILES[0]); ++i)
+		{
+			// nearest rank: the smallest sample at or above the share
+			size_t rank = static_cast<size_t>(std::ceil(PERCENTILES[i] / 100 * sorted.size()));
+			out << std::setw(12) << sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1] / NS_PER_US;
+		}
+
+		out << std::setw(12) << sorted.back() / NS_PER_US << '\n';
+	}
+
+} // namespace
+
+bool startRecording(const std::string& path)
+{
+	boost::mutex::scoped_lock lock(recordingSync);
+
+	// readable by the owner only, the lines may hold passwords
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_NOFOLLOW | O_CLOEXEC, 0600);
+
+	if (fd < 0)
+		return false;
+
+	FILE* file = fdopen(fd, "a");
+
+	if (file == NULL)
+	{
+		::close(fd);
+		return false;
+	}
+
+	if (recording)
+		fclose(recording);
+
+	recording = file;
+	recordingStart = Statistics::now();
+	recordingActive = true;
+
+	return true;
+}
+
+void stopRecording()
+{
+	boost::mutex::scoped_lock lock(recordingSync);
+
+	recordingActive = false;
+
+	if (recording)
+		fclose(recording);
+
+	recording = NULL;
+}
+
+void recordLine(const Session& session, const std::string& line)
+{
+	if (!recordingActive.load(boost::memory_order_relaxed))
+		return;
+
+	boost::mutex::scoped_lock lock(recordingSync);
+
+	if (!recording)
+		return;
+
+	unsigned long long time = (Statistics::now() - recordingStart) / NS_PER_US;
+
+	// a line at a time, so that a crash loses nothing of the traffic before it
+	fprintf(recording, "%llu\t%u\t%s\n", time, session.id, line.c_str());
+	fflush(recording);
+}
+
+bool replayRecording(const std::string& path, const ReplayOptions& options, ReplayReport& report)
+{
+	std::vector<Record> records;
+
+	if (!loadRecording(path, records))
+		return false;
+
+	// every recorded session becomes 'copies' simulated ones
+	typedef std::map<unsigned, size_t> SessionIndexType_t;
+	SessionIndexType_t first;
+	std::vector<SessionPtr_t> sessions;
+
+	for (std::vector<Record>::const_iterator It = records.begin(); It != records.end(); ++It)
+	{
+		if (first.count(It->session))
+			continue;
+
+		first[It->session] = sessions.size();
+
+		for (unsigned copy = 0; copy < options.copies; ++copy)
+		{
+			sessions.push_back(SessionPtr_t(new Session));
+			sessions.back()->output.setDescriptor(-1);
+		}
+	}
+
+	report = ReplayReport();
+	report.sessions = sessions.size();
+	report.service.reserve(records.size() * options.copies);
+	report.response.reserve(records.size() * options.copies);
+
+	boost::uint64_t start = Statistics::now();
+	boost::uint64_t previous = start;
+
+	for (std::vector<Record>::const_iterator It = records.begin(); It != records.end(); ++It)
+	{
+		boost::uint64_t due = options.speed > 0 ?
+				start + static_cast<boost::uint64_t>(It->time * NS_PER_US / options.speed) : 0;
+
+		for (unsigned copy = 0; copy < options.copies; ++copy)
+		{
+			Session& session = *sessions[first[It->session] + copy];
+
+			sleepUntil(due);
+
+			boost::uint64_t begin = Statistics::now();
+
+			if (!executeLine(session, It->line))
+				++report.failed;
+
+			// what the prompt would do
+			JobManager::Instance().flush(&session, session.output.stream());
+			session.output.flush();
+
+			boost::uint64_t end = Statistics::now();
+
+			report.service.push_back(end - begin);
+			// a line waits only if the one before ran past its time,
+			// being woken up late is not the engine's doing
+			report.response.push_back(end - (options.speed > 0 && previous > due ? due : begin));
+			previous = end;
+		}
+	}
+
+	report.elapsed = Statistics::now() - start;
+
+	for (std::vector<SessionPtr_t>::const_iterator It = sessions.begin(); It != sessions.end(); ++It)
+		JobManager::Instance().release(It->get());
+
+	std::sort(report.service.begin(), report.service.end());
+	std::sort(report.response.begin(), report.response.end());
+
+	return true;
+}
+
+void printReplayReport(const ReplayReport& report, std::ostream& out)
+{
+	size_t lines = report.service.size();
+	double seconds = static_cast<double>(report.elapsed) / NS_PER_S;
+
+	out << "Sessions: " << report.sessions << '\n'
+		<< "Lines: " << lines << ", rejected " << report.failed << '\n'
+		<< "Elapsed: " << std::fixed << std::setprecision(3) << seconds << " s\n"
+		<< "Throughput: " << std::setprecision(1) << (seconds > 0 ? lines / seconds : 0) << " lines/s\n";
+
+	if (lines == 0)
+		return;
+
+	out << "\nLatency, us" << '\n' << std::setw(10) << "";
+
+	for (size_t i = 0; i < sizeof(PERCENTILES) / sizeof(PERCENTILES[0]); ++i)
+	{
+		std::ostringstream title;
+		title << "p" << PERCENTILES[i];
+		out << std::setw(12) << title.str();
+	}
+
+	out << std::setw(12) << "max" << '\n';
+
+	printPercentiles("service", report.service, out);
+	printPercentiles("response", report.response, out);
+}
+
+} // CLI
@@ -0,0 +1,83 @@
+/*
+ * cliRecorder.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIRECORDER_H_
+#define CLIRECORDER_H_
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+namespace CLI {
+
+	struct Session;
+
+	/*
+	 * Log of the lines entered in all sessions, to replay production
+	 * traffic against the engine. One record per line:
+	 *
+	 *   <microseconds since the recording started> TAB <Session::id> TAB <line>
+	 *
+	 * Lines are recorded as typed, passwords and other secrets given as
+	 * parameters included. The file is created with mode 0600 and must
+	 * be handled like the credentials it may hold. A symbolic link is
+	 * not followed.
+	 */
+	bool startRecording(const std::string& path);
+	void stopRecording();
+
+	/* Called where lines enter the engine, does nothing while not recording */
+	void recordLine(const Session& session, const std::string& line);
+
+	struct ReplayOptions
+	{
+		ReplayOptions() : speed(1.0), copies(1) {}
+
+		/* 1 keeps the recorded pace, 10 is ten times faster, 0 runs the lines back to back */
+		double   speed;
+
+		/*
+		 * Simulated sessions per recorded one, all entering the same lines.
+		 * The copies take turns on one thread: each line is entered by every
+		 * copy in a row, so N copies give N times the work, not N sessions
+		 * typing at the same time.
+		 */
+		unsigned copies;
+	};
+
+	struct ReplayReport
+	{
+		ReplayReport() : sessions(0), failed(0), elapsed(0) {}
+
+		size_t          sessions;
+		size_t          failed;    // lines rejected by the engine
+		boost::uint64_t elapsed;   // ns
+
+		/*
+		 * Per line, sorted, in ns: the time the engine took and the same
+		 * plus the time the line waited behind earlier ones
+		 */
+		std::vector<boost::uint64_t> service;
+		std::vector<boost::uint64_t> response;
+	};
+
+	/*
+	 * Enters the recorded lines into new sessions through executeLine(),
+	 * without readline, at the pace of the options, one line at a time
+	 * as the engine runs lines. The output of the sessions is dropped.
+	 * Must not run next to other users of the engine.
+	 */
+	bool replayRecording(const std::string& path, const ReplayOptions& options, ReplayReport& report);
+
+	/* Throughput and latency percentiles */
+	void printReplayReport(const ReplayReport& report, std::ostream& out);
+
+} // CLI
+
+#endif /* CLIRECORDER_H_ */
@@ -0,0 +1,429 @@
+/*
+ * cliRegistrySnapshot.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "cliRegistrySnapshot.h"
+
+namespace CLI {
+
+namespace {
+
+	const char SNAPSHOT_MAGIC[8] = { 'C', 'L', 'I', 'R', 'E', 'G', '\0', '\0' };
+
+	typedef std::vector<boost::uint32_t> OffsetContainer_t;
+
+	/*
+	 * Lays the snapshot out in memory. Strings and lists which are equal
+	 * are written once, keywords and help lines repeat a lot.
+	 */
+	class SnapshotWriter
+	{
+		public:
+			explicit SnapshotWriter(size_t reserved) : data_(reserved, '\0') {}
+
+			boost::uint32_t string(const std::string& text)
+			{
+				StringPoolType_t::const_iterator It = strings_.find(text);
+				if (It != strings_.end())
+					return It->second;
+
+				boost::uint32_t offset = word(text.size());
+				data_.append(text);
+				data_.append((4 - text.size() % 4) % 4, '\0');
+
+				strings_[text] = offset;
+				return offset;
+			}
+
+			boost::uint32_t list(const OffsetContainer_t& items)
+			{
+				ListPoolType_t::const_iterator It = lists_.find(items);
+				if (It != lists_.end())
+					return It->second;
+
+				boost::uint32_t offset = word(items.size());
+				for (OffsetContainer_t::const_iterator itemIt = items.begin(); itemIt != items.end(); ++itemIt)
+					word(*itemIt);
+
+				lists_[items] = offset;
+				return offset;
+			}
+
+			boost::uint32_t strings(const BasicStringContainer_t& texts)
+			{
+				OffsetContainer_t items;
+				for (BasicStringContainer_t::const_iterator It = texts.begin(); It != texts.end(); ++It)
+					items.push_back(string(*It));
+
+				return list(items);
+			}
+
+			void put(size_t offset, const void* value, size_t size)
+			{
+				data_.replace(offset, size, static_cast<const char*>(value), size);
+			}
+
+			const std::string& data() const { return data_; }
+
+		private:
+			typedef std::map<std::string, boost::uint32_t>       StringPoolType_t;
+			typedef std::map<OffsetContainer_t, boost::uint32_t> ListPoolType_t;
+
+			boost::uint32_t word(boost::uint32_t value)
+			{
+				boost::uint32_t offset = data_.size();
+				data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+				return offset;
+			}
+
+			std::string      data_;
+			StringPoolType_t strings_;
+			ListPoolType_t   lists_;
+	};
+
+	struct EntryOrder
+	{
+		bool operator()(const RegistrySnapshot::Entry* lhs, const RegistrySnapshot::Entry* rhs) const
+		{
+			if (lhs->context != rhs->context)
+				return lhs->context < rhs->context;
+
+			return lhs->key < rhs->key;
+		}
+	};
+
+} // namespace
+
+struct RegistrySnapshot::Header
+{
+	char            magic[8];
+	boost::uint32_t format;
+	boost::uint32_t size;       // of the whole file
+	boost::uint32_t identity;   // string
+	boost::uint32_t count;
+	boost::uint32_t records;    // first record
+	boost::uint32_t reserved;
+};
+
+struct RegistrySnapshot::Record
+{
+	boost::uint32_t context;
+	boost::uint32_t key;        // string
+	boost::uint32_t access;
+	boost::uint32_t keywords;   // list of strings
+	boost::uint32_t levels;     // list of lists of strings
+};
+
+RegistrySnapshot::RegistrySnapshot() :
+	data_(NULL), size_(0), header_(NULL)
+{
+}
+
+RegistrySnapshot::~RegistrySnapshot()
+{
+	if (data_ != NULL)
+		::munmap(const_cast<char*>(data_), size_);
+}
+
+bool RegistrySnapshot::open(const std::string& path, const std::string& identity)
+{
+	if (data_ != NULL)
+		return false;
+
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* mapping = ::mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if (mapping == MAP_FAILED)
+		return false;
+
+	data_ = static_cast<const char*>(mapping);
+	size_ = st.st_size;
+	header_ = reinterpret_cast<const Header*>(data_);
+
+	boost::uint32_t length = 0;
+	const char* text = NULL;
+
+	bool valid = memcmp(header_->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+			header_->format == FORMAT_VERSION && header_->size == size_ &&
+			header_->records <= size_ && header_->count <= (size_ - header_->records) / sizeof(Record) &&
+			(text = string(header_->identity, length)) != NULL &&
+			identity.compare(0, std::string::npos, text, length) == 0;
+
+	if (!valid)
+	{
+		::munmap(mapping, size_);
+		data_ = NULL;
+		size_ = 0;
+		header_ = NULL;
+	}
+
+	return valid;
+}
+
+bool RegistrySnapshot::save(const std::string& path, const std::string& identity,
+		const EntryContainer_t& entries)
+{
+	std::vector<const Entry*> sorted;
+	for (EntryContainer_t::const_iterator It = entries.begin(); It != entries.end(); ++It)
+		sorted.push_back(&*It);
+
+	std::sort(sorted.begin(), sorted.end(), EntryOrder());
+
+	SnapshotWriter writer(sizeof(Header) + sorted.size() * sizeof(Record));
+
+	Header header;
+	memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.format = FORMAT_VERSION;
+	header.identity = writer.string(identity);
+	header.count = sorted.size();
+	header.records = sizeof(Header);
+	header.reserved = 0;
+
+	BasicStringContainer_t keywords;
+	CommandIndex::HelpLevelContainer_t levels;
+
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		const Entry& entry = *sorted[i];
+
+		keywords.clear();
+		levels.clear();
+
+		// a snapshot command answers this from its own snapshot
+		if (entry.command)
+			CommandIndex::keywordPath(entry.command, keywords, &levels);
+
+		OffsetContainer_t levelItems;
+		for (CommandIndex::HelpLevelContainer_t::const_iterator It = levels.begin(); It != levels.end(); ++It)
+			levelItems.push_back(writer.strings(*It));
+
+		Record record;
+		record.context = entry.context;
+		record.key = writer.string(entry.key);
+		record.access = entry.access;
+		record.keywords = writer.strings(keywords);
+		record.levels = writer.list(levelItems);
+
+		writer.put(sizeof(Header) + i * sizeof(Record), &record, sizeof(record));
+	}
+
+	header.size = writer.data().size();
+	writer.put(0, &header, sizeof(header));
+
+	// readers see either the old or the new snapshot
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream output(temporary.c_str(), std::ios::binary | std::ios::trunc);
+		output.write(writer.data().data(), writer.data().size());
+
+		if (!output.flush())
+			return false;
+	}
+
+	return ::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+size_t RegistrySnapshot::size() const
+{
+	return header_ != NULL ? header_->count : 0;
+}
+
+const RegistrySnapshot::Record* RegistrySnapshot::record(size_t index) const
+{
+	return reinterpret_cast<const Record*>(data_ + header_->records) + index;
+}
+
+const char* RegistrySnapshot::string(boost::uint32_t offset, boost::uint32_t& length) const
+{
+	if (offset > size_ - sizeof(boost::uint32_t) || offset % sizeof(boost::uint32_t) != 0)
+		return NULL;
+
+	length = *reinterpret_cast<const boost::uint32_t*>(data_ + offset);
+	offset += sizeof(boost::uint32_t);
+
+	if (length > size_ - offset)
+		return NULL;
+
+	return data_ + offset;
+}
+
+const boost::uint32_t* RegistrySnapshot::list(boost::uint32_t offset, boost::uint32_t& count) const
+{
+	if (offset > size_ - sizeof(boost::uint32_t) || offset % sizeof(boost::uint32_t) != 0)
+		return NULL;
+
+	count = *reinterpret_cast<const boost::uint32_t*>(data_ + offset);
+	offset += sizeof(boost::uint32_t);
+
+	if (count > (size_ - offset) / sizeof(boost::uint32_t))
+		return NULL;
+
+	return reinterpret_cast<const boost::uint32_t*>(data_ + offset);
+}
+
+int RegistrySnapshot::find(Context_t context, const std::string& key) const
+{
+	size_t low = 0, high = size();
+
+	while (low < high)
+	{
+		size_t middle = low + (high - low) / 2;
+		const Record* current = record(middle);
+
+		boost::uint32_t length = 0;
+		const char* text = string(current->key, length);
+
+		if (text == NULL)
+			return -1;
+
+		int order = static_cast<int>(current->context) - static_cast<int>(context);
+		if (order == 0)
+			order = -key.compare(0, std::string::npos, text, length);
+
+		if (order == 0)
+			return middle;
+
+		if (order < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return -1;
+}
+
+size_t RegistrySnapshot::keywords(size_t index) const
+{
+	boost::uint32_t count = 0;
+	return list(record(index)->keywords, count) != NULL ? count : 0;
+}
+
+size_t RegistrySnapshot::levels(size_t index) const
+{
+	boost::uint32_t count = 0;
+	return list(record(index)->levels, count) != NULL ? count : 0;
+}
+
+bool RegistrySnapshot::keywordEquals(size_t index, size_t keyword, const std::string& token) const
+{
+	boost::uint32_t count = 0, length = 0;
+	const boost::uint32_t* items = list(record(index)->keywords, count);
+
+	if (items == NULL || keyword >= count)
+		return false;
+
+	const char* text = string(items[keyword], length);
+
+	return text != NULL && token.compare(0, std::string::npos, text, length) == 0;
+}
+
+void RegistrySnapshot::help(size_t index, size_t level, BasicStringContainer_t& lines) const
+{
+	boost::uint32_t count = 0, length = 0;
+	const boost::uint32_t* items = list(record(index)->levels, count);
+
+	if (items == NULL || level >= count)
+		return;
+
+	const boost::uint32_t* strings = list(items[level], count);
+
+	for (boost::uint32_t i = 0; strings != NULL && i < count; ++i)
+	{
+		const char* text = string(strings[i], length);
+
+		if (text != NULL)
+			lines.push_back(std::string(text, length));
+	}
+}
+
+/*****************************************************************************/
+/*                            SnapshotCommand                                */
+/*****************************************************************************/
+SnapshotCommand::SnapshotCommand(const RegistrySnapshotPtr_t& snapshot, size_t record, const CommandFactory_t& factory) :
+	snapshot_(snapshot), record_(record), factory_(factory)
+{
+}
+
+bool SnapshotCommand::onPath(const std::vector<std::string>& tokens) const
+{
+	if (tokens.size() >= snapshot_->levels(record_))
+		return false;
+
+	for (size_t i = 0; i < tokens.size(); ++i)
+	{
+		if (!snapshot_->keywordEquals(record_, i, tokens[i]))
+			return false;
+	}
+
+	return true;
+}
+
+const CommandPtr_t& SnapshotCommand::bound()
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	if (!command_)
+		command_ = factory_();
+
+	return command_;
+}
+
+bool SnapshotCommand::validate(const std::vector<std::string>& tokens, ParameterStorageType_t& paramStorage, CommandError_t& cmdError)
+{
+	// keywords are still missing, e.g. while context help is collected
+	if (tokens.size() < snapshot_->keywords(record_) && onPath(tokens))
+	{
+		cmdError.error = CLI_CMD_SHORT;
+		cmdError.position = tokens.end();
+		return false;
+	}
+
+	return bound()->validate(tokens, paramStorage, cmdError);
+}
+
+void SnapshotCommand::getContextHelp(const std::vector<std::string>& tokens, std::vector<std::string>& help)
+{
+	if (onPath(tokens))
+	{
+		snapshot_->help(record_, tokens.size(), help);
+		return;
+	}
+
+	bound()->getContextHelp(tokens, help);
+}
+
+char* SnapshotCommand::completion(bool get, const std::vector<std::string>& tokens, int& startWithIndex)
+{
+	return bound()->completion(get, tokens, startWithIndex);
+}
+
+void SnapshotCommand::execute(const ParameterStorageType_t& paramStorage, const std::string& group)
+{
+	bound()->execute(paramStorage, group);
+}
+
+} // CLI
@@ -0,0 +1,155 @@
+/*
+ * cliRegistrySnapshot.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIREGISTRYSNAPSHOT_H_
+#define CLIREGISTRYSNAPSHOT_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cliApi.h"
+#include "cliCommand.h"
+#include "cliCommandIndex.h"
+
+namespace CLI {
+
+	typedef boost::function<CommandPtr_t ()> CommandFactory_t;
+
+	/*
+	 * Registration of a command which is only made by 'factory' when it is
+	 * needed. 'key' names the command in registry snapshots and has to be
+	 * unique within the context and stable between builds.
+	 *
+	 * With a registry snapshot loaded the command is not made: keywords and
+	 * help come from the snapshot. The security hook is asked per user
+	 * group once the group is first seen.
+	 */
+	void registerCommand(const ModulePtr_t& module,
+			const std::string& key,
+			const CommandFactory_t& factory,
+			securityHook hook,
+			Context_t context,
+			CommandAccess_t access = CLI_ACCESS_EXCLUSIVE,
+			const CachePolicy& cache = CachePolicy());
+
+	/*
+	 * Maps the snapshot written by a previous start. It is used only if it
+	 * was saved by the same 'build'. Has to be
+	 * called before the modules register their commands.
+	 */
+	bool loadRegistrySnapshot(const std::string& path, const std::string& build);
+
+	/*
+	 * Writes the commands registered through factories, once every module
+	 * has registered. Nothing is written while the loaded snapshot is
+	 * up to date.
+	 */
+	bool saveRegistrySnapshot(const std::string& path, const std::string& build);
+
+	/*
+	 * Memory mapped registry snapshot.
+	 *
+	 * The file holds one record per factory registration: context, key,
+	 * access, the keyword path and the context help seen at each keyword
+	 * of the path. Records are
+	 * sorted by context and key and every string is stored once; nothing
+	 * is copied out of the mapping until it is asked for.
+	 */
+	class RegistrySnapshot
+	{
+		public:
+			enum { FORMAT_VERSION = 2 };
+
+			/* Registration as written to a snapshot */
+			struct Entry
+			{
+				Context_t       context;
+				std::string     key;
+				CommandAccess_t access;
+				CommandPtr_t    command;   // made by the factory or restored from a snapshot
+			};
+
+			typedef std::vector<Entry> EntryContainer_t;
+
+			RegistrySnapshot();
+			~RegistrySnapshot();
+
+			bool open(const std::string& path, const std::string& identity);
+
+			static bool save(const std::string& path, const std::string& identity,
+					const EntryContainer_t& entries);
+
+			size_t size() const;
+
+			/* Record of a registration, -1 if the snapshot does not know it */
+			int find(Context_t context, const std::string& key) const;
+
+			/* Keywords of the path, help levels are one more unless the path is at its limit */
+			size_t keywords(size_t record) const;
+			size_t levels(size_t record) const;
+
+			bool keywordEquals(size_t record, size_t keyword, const std::string& token) const;
+			void help(size_t record, size_t level, BasicStringContainer_t& lines) const;
+
+		private:
+			struct Header;
+			struct Record;
+
+			RegistrySnapshot(const RegistrySnapshot&);
+			RegistrySnapshot& operator=(const RegistrySnapshot&);
+
+			const Record* record(size_t index) const;
+
+			/* String or list at an offset, NULL if it is out of the file */
+			const char* string(boost::uint32_t offset, boost::uint32_t& length) const;
+			const boost::uint32_t* list(boost::uint32_t offset, boost::uint32_t& count) const;
+
+			const char*   data_;
+			size_t        size_;
+			const Header* header_;
+	};
+
+	typedef boost::shared_ptr<const RegistrySnapshot> RegistrySnapshotPtr_t;
+
+	/*
+	 * Command restored from a snapshot. Context help along the keyword
+	 * path is answered from the snapshot, anything else makes the real
+	 * command and passes the call on.
+	 */
+	class SnapshotCommand : public Command
+	{
+		public:
+			SnapshotCommand(const RegistrySnapshotPtr_t& snapshot, size_t record, const CommandFactory_t& factory);
+
+			bool validate(const std::vector<std::string>& tokens, ParameterStorageType_t& paramStorage, CommandError_t& cmdError);
+			void getContextHelp(const std::vector<std::string>& tokens, std::vector<std::string>& help);
+			char* completion(bool get, const std::vector<std::string>& tokens, int& startWithIndex);
+			void execute(const ParameterStorageType_t& paramStorage, const std::string& group);
+
+		private:
+			/* Tokens equal to the first keywords of the path */
+			bool onPath(const std::vector<std::string>& tokens) const;
+
+			const CommandPtr_t& bound();
+
+			RegistrySnapshotPtr_t snapshot_;
+			size_t                record_;
+			CommandFactory_t      factory_;
+
+			boost::mutex          sync_;
+			CommandPtr_t          command_;
+	};
+
+} // CLI
+
+#endif /* CLIREGISTRYSNAPSHOT_H_ */
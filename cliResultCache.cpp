@@ -0,0 +1,146 @@
+/*
+ * cliResultCache.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "cliResultCache.h"
+
+namespace CLI {
+
+namespace {
+
+	/* Results kept at most, the least recently used goes first */
+	const size_t RESULT_CACHE_SIZE = 256;
+
+	/* Length and text, so no text can pass for a field boundary */
+	void appendField(std::ostringstream& key, const std::string& field)
+	{
+		key << field.size() << ':' << field;
+	}
+
+} // namespace
+
+ResultCache::ResultCache() :
+	generation_(0)
+{
+}
+
+ResultCache& ResultCache::Instance()
+{
+	static ResultCache instance;
+	return instance;
+}
+
+std::string ResultCache::key(const void* command, const std::string& group,
+		const ParameterStorageType_t& paramStorage)
+{
+	std::ostringstream result;
+
+	result << command << ' ';
+	appendField(result, group);
+
+	// the parameters are sorted by name, whatever order they were typed in
+	for (ParameterStorageType_t::const_iterator It = paramStorage.begin(); It != paramStorage.end(); ++It)
+	{
+		appendField(result, It->first);
+		appendField(result, It->second);
+	}
+
+	return result.str();
+}
+
+bool ResultCache::find(const std::string& key, boost::uint64_t now, std::string& output)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	EntryIndexType_t::iterator It = index_.find(key);
+
+	if (It == index_.end())
+		return false;
+
+	if (It->second->expires <= now)
+	{
+		erase(It->second);
+		return false;
+	}
+
+	entries_.splice(entries_.begin(), entries_, It->second);
+	output = It->second->output;
+
+	return true;
+}
+
+unsigned ResultCache::generation()
+{
+	boost::mutex::scoped_lock lock(sync_);
+	return generation_;
+}
+
+void ResultCache::insert(const std::string& key, const std::string& output, boost::uint64_t expires,
+		const BasicStringContainer_t& tags, unsigned generation)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	if (generation != generation_)
+		return;
+
+	EntryIndexType_t::iterator It = index_.find(key);
+
+	if (It != index_.end())
+		erase(It->second);
+
+	Entry entry;
+	entry.key = key;
+	entry.output = output;
+	entry.expires = expires;
+	entry.tags = tags;
+
+	entries_.push_front(entry);
+	index_[key] = entries_.begin();
+
+	if (entries_.size() > RESULT_CACHE_SIZE)
+		erase(--entries_.end());
+}
+
+void ResultCache::invalidate(const std::string& tag)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	++generation_;
+
+	EntryStorageType_t::iterator It = entries_.begin();
+	while (It != entries_.end())
+	{
+		EntryStorageType_t::iterator entry = It++;
+
+		if (std::find(entry->tags.begin(), entry->tags.end(), tag) != entry->tags.end())
+			erase(entry);
+	}
+}
+
+void ResultCache::clear()
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	entries_.clear();
+	index_.clear();
+	++generation_;
+}
+
+void ResultCache::erase(EntryStorageType_t::iterator entry)
+{
+	index_.erase(entry->key);
+	entries_.erase(entry);
+}
+
+void invalidateResults(const std::string& tag)
+{
+	ResultCache::Instance().invalidate(tag);
+}
+
+} // CLI
@@ -0,0 +1,86 @@
+/*
+ * cliResultCache.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIRESULTCACHE_H_
+#define CLIRESULTCACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cliApi.h"
+
+namespace CLI {
+
+	/*
+	 * Output of commands which declared it may be reused, see CachePolicy.
+	 *
+	 * The key is made of the command, the user group and the parameters
+	 * validate() stored, so lines which differ only in abbreviations or
+	 * spacing share the entry. An entry is dropped when its time to live
+	 * is over or when one of its tags is invalidated.
+	 */
+	class ResultCache
+	{
+		public:
+			static ResultCache& Instance();
+
+			static std::string key(const void* command, const std::string& group,
+					const ParameterStorageType_t& paramStorage);
+
+			/* 'now' as by Statistics::now() */
+			bool find(const std::string& key, boost::uint64_t now, std::string& output);
+
+			/*
+			 * Output computed while generation() returned 'generation' is
+			 * dropped if results were invalidated in the meantime
+			 */
+			void insert(const std::string& key, const std::string& output, boost::uint64_t expires,
+					const BasicStringContainer_t& tags, unsigned generation);
+
+			unsigned generation();
+
+			/* Drops the results carrying the tag */
+			void invalidate(const std::string& tag);
+
+			void clear();
+
+		private:
+			ResultCache();
+
+			struct Entry
+			{
+				std::string             key;
+				std::string             output;
+				boost::uint64_t         expires;
+				BasicStringContainer_t  tags;
+			};
+
+			typedef std::list<Entry>                                    EntryStorageType_t;
+			typedef std::map<std::string, EntryStorageType_t::iterator> EntryIndexType_t;
+
+			void erase(EntryStorageType_t::iterator entry);
+
+			unsigned           generation_;
+			EntryStorageType_t entries_;   // most recently used first
+			EntryIndexType_t   index_;
+			boost::mutex       sync_;
+	};
+
+	/*
+	 * For commands which change what cached results show, when the tags
+	 * to drop depend on the parameters. Fixed tags are better given to
+	 * the registration, see CachePolicy::invalidates.
+	 */
+	void invalidateResults(const std::string& tag);
+
+} // CLI
+
+#endif /* CLIRESULTCACHE_H_ */
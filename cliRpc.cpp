@@ -0,0 +1,491 @@
+/*
+ * cliRpc.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cliRpc.h"
+#include "cliTokenizer.h"
+
+namespace CLI {
+
+namespace {
+
+	/* Nesting of values skipped in a request */
+	const int MAX_DEPTH = 32;
+
+	/*
+	 * Reader of the few JSON values a request holds, it works on the
+	 * line in place
+	 */
+	class JsonReader
+	{
+		public:
+			JsonReader(const std::string& text) :
+				It_(text.data()), end_(text.data() + text.size())
+			{}
+
+			bool atEnd()
+			{
+				skipSpace();
+				return It_ == end_;
+			}
+
+			/* Consumes the character if it comes next */
+			bool consume(char c)
+			{
+				skipSpace();
+
+				if (It_ == end_ || *It_ != c)
+					return false;
+
+				++It_;
+				return true;
+			}
+
+			bool string(std::string& result);
+			bool strings(BasicStringContainer_t& result);
+
+			/* A number, string or null as its JSON text */
+			bool scalar(std::string& result);
+
+			bool skip(int depth = 0);
+
+		private:
+			void skipSpace()
+			{
+				while (It_ != end_ && (*It_ == ' ' || *It_ == '\t' || *It_ == '\r' || *It_ == '\n'))
+					++It_;
+			}
+
+			bool word(const char* text)
+			{
+				size_t length = strlen(text);
+
+				if (static_cast<size_t>(end_ - It_) < length || strncmp(It_, text, length) != 0)
+					return false;
+
+				It_ += length;
+				return true;
+			}
+
+			bool number();
+
+			const char* digits(const char* It) const
+			{
+				while (It != end_ && isdigit(static_cast<unsigned char>(*It)))
+					++It;
+
+				return It;
+			}
+
+			bool hex(unsigned& code);
+
+			const char* It_;
+			const char* end_;
+	};
+
+	void appendUtf8(std::string& result, unsigned code)
+	{
+		if (code < 0x80)
+			result += static_cast<char>(code);
+		else if (code < 0x800)
+		{
+			result += static_cast<char>(0xC0 | (code >> 6));
+			result += static_cast<char>(0x80 | (code & 0x3F));
+		}
+		else if (code < 0x10000)
+		{
+			result += static_cast<char>(0xE0 | (code >> 12));
+			result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+			result += static_cast<char>(0x80 | (code & 0x3F));
+		}
+		else
+		{
+			result += static_cast<char>(0xF0 | (code >> 18));
+			result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+			result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+			result += static_cast<char>(0x80 | (code & 0x3F));
+		}
+	}
+
+	bool JsonReader::hex(unsigned& code)
+	{
+		if (end_ - It_ < 4)
+			return false;
+
+		code = 0;
+
+		for (int i = 0; i < 4; ++i, ++It_)
+		{
+			char c = *It_;
+			code <<= 4;
+
+			if (c >= '0' && c <= '9')
+				code |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				code |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				code |= c - 'A' + 10;
+			else
+				return false;
+		}
+
+		return true;
+	}
+
+	bool JsonReader::string(std::string& result)
+	{
+		if (!consume('"'))
+			return false;
+
+		result.clear();
+
+		while (It_ != end_)
+		{
+			char c = *It_++;
+
+			if (c == '"')
+				return true;
+
+			// control characters are escaped in JSON
+			if (static_cast<unsigned char>(c) < 0x20)
+				return false;
+
+			if (c != '\\')
+			{
+				result += c;
+				continue;
+			}
+
+			if (It_ == end_)
+				return false;
+
+			switch (*It_++)
+			{
+			case '"':  result += '"';  break;
+			case '\\': result += '\\'; break;
+			case '/':  result += '/';  break;
+			case 'b':  result += '\b'; break;
+			case 'f':  result += '\f'; break;
+			case 'n':  result += '\n'; break;
+			case 'r':  result += '\r'; break;
+			case 't':  result += '\t'; break;
+			case 'u':
+			{
+				unsigned code;
+				if (!hex(code))
+					return false;
+
+				// a surrogate pair stands for one character, a lone surrogate for none
+				if (code >= 0xDC00 && code < 0xE000)
+					return false;
+
+				if (code >= 0xD800 && code < 0xDC00)
+				{
+					unsigned low;
+					if (!word("\\u") || !hex(low) || low < 0xDC00 || low >= 0xE000)
+						return false;
+
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+
+				appendUtf8(result, code);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		return false;
+	}
+
+	bool JsonReader::strings(BasicStringContainer_t& result)
+	{
+		result.clear();
+
+		if (!consume('['))
+			return false;
+
+		if (consume(']'))
+			return true;
+
+		do
+		{
+			result.push_back(std::string());
+
+			if (!string(result.back()))
+				return false;
+		}
+		while (consume(','));
+
+		return consume(']');
+	}
+
+	/* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+	bool JsonReader::number()
+	{
+		const char* It = It_;
+
+		if (It != end_ && *It == '-')
+			++It;
+
+		if (It == end_ || !isdigit(static_cast<unsigned char>(*It)))
+			return false;
+
+		if (*It == '0')
+			++It;
+		else
+			It = digits(It);
+
+		if (It != end_ && *It == '.')
+		{
+			const char* fraction = ++It;
+
+			if ((It = digits(It)) == fraction)
+				return false;
+		}
+
+		if (It != end_ && (*It == 'e' || *It == 'E'))
+		{
+			if (++It != end_ && (*It == '+' || *It == '-'))
+				++It;
+
+			const char* exponent = It;
+
+			if ((It = digits(It)) == exponent)
+				return false;
+		}
+
+		It_ = It;
+		return true;
+	}
+
+	bool JsonReader::scalar(std::string& result)
+	{
+		skipSpace();
+
+		const char* begin = It_;
+		std::string text;
+
+		if (!(word("null") || number() || string(text)))
+			return false;
+
+		result.assign(begin, It_);
+		return true;
+	}
+
+	bool JsonReader::skip(int depth)
+	{
+		if (depth > MAX_DEPTH)
+			return false;
+
+		std::string text;
+
+		if (consume('['))
+		{
+			if (consume(']'))
+				return true;
+
+			do
+			{
+				if (!skip(depth + 1))
+					return false;
+			}
+			while (consume(','));
+
+			return consume(']');
+		}
+
+		if (consume('{'))
+		{
+			if (consume('}'))
+				return true;
+
+			do
+			{
+				if (!string(text) || !consume(':') || !skip(depth + 1))
+					return false;
+			}
+			while (consume(','));
+
+			return consume('}');
+		}
+
+		skipSpace();
+
+		return word("true") || word("false") || scalar(text);
+	}
+
+	void appendString(std::string& reply, const std::string& text)
+	{
+		reply += '"';
+
+		for (std::string::const_iterator It = text.begin(); It != text.end(); ++It)
+		{
+			unsigned char c = static_cast<unsigned char>(*It);
+
+			switch (c)
+			{
+			case '"':  reply += "\\\""; break;
+			case '\\': reply += "\\\\"; break;
+			case '\n': reply += "\\n";  break;
+			case '\r': reply += "\\r";  break;
+			case '\t': reply += "\\t";  break;
+			default:
+				if (c < 0x20)
+				{
+					char code[8];
+					snprintf(code, sizeof(code), "\\u%04x", c);
+					reply += code;
+				}
+				else
+					reply += *It;
+			}
+		}
+
+		reply += '"';
+	}
+
+	const char* errorCode(CommandErrorCode_t error)
+	{
+		switch (error)
+		{
+		case CLI_CMD_SHORT:          return "short";
+		case CLI_CMD_TOO_LONG:       return "too_long";
+		case CLI_CMD_WRONG_KEYWORD:  return "wrong_keyword";
+		case CLI_CMD_WRONG_VALUE:    return "wrong_value";
+		default:                     return "rejected";
+		}
+	}
+
+} // namespace
+
+bool parseRpcRequest(const std::string& line, RpcRequest& request, std::string& problem)
+{
+	JsonReader reader(line);
+	std::string key, text;
+	bool command = false;
+
+	request.id = "null";
+	request.args.clear();
+
+	if (!reader.consume('{'))
+	{
+		problem = "request is not a JSON object";
+		return false;
+	}
+
+	if (!reader.consume('}'))
+	{
+		do
+		{
+			if (!reader.string(key) || !reader.consume(':'))
+			{
+				problem = "malformed object";
+				return false;
+			}
+
+			bool valid;
+
+			if (key == "id")
+				valid = reader.scalar(request.id);
+			else if (key == "args")
+				valid = command = reader.strings(request.args);
+			else if (key == "line")
+			{
+				valid = command = reader.string(text);
+
+				Tokenizer tokenizer;
+				tokenizer.split(text);
+				tokenizer.assign(request.args);
+			}
+			else
+				valid = reader.skip();
+
+			if (!valid)
+			{
+				problem = "bad value of \"" + key + "\"";
+				return false;
+			}
+		}
+		while (reader.consume(','));
+
+		if (!reader.consume('}'))
+		{
+			problem = "malformed object";
+			return false;
+		}
+	}
+
+	if (!reader.atEnd())
+	{
+		problem = "text after the request";
+		return false;
+	}
+
+	if (!command)
+	{
+		problem = "no \"args\" or \"line\"";
+		return false;
+	}
+
+	return true;
+}
+
+void appendRpcResult(std::string& reply, const std::string& id, const std::string& output)
+{
+	reply += "{\"id\":";
+	reply += id;
+	reply += ",\"ok\":true,\"output\":";
+	appendString(reply, output);
+	reply += "}\n";
+}
+
+void appendRpcError(std::string& reply, const std::string& id, const CommandError_t& cmdError,
+		const BasicStringContainer_t& tokens, size_t position, const std::string& output)
+{
+	char number[32];
+	snprintf(number, sizeof(number), "%lu", static_cast<unsigned long>(position));
+
+	reply += "{\"id\":";
+	reply += id;
+	reply += ",\"ok\":false,\"error\":{\"code\":\"";
+	reply += errorCode(cmdError.error);
+	reply += "\",\"position\":";
+	reply += number;
+
+	if (position < tokens.size())
+	{
+		reply += ",\"token\":";
+		appendString(reply, tokens[position]);
+	}
+
+	if (!cmdError.description.empty())
+	{
+		reply += ",\"description\":";
+		appendString(reply, cmdError.description);
+	}
+
+	reply += "},\"output\":";
+	appendString(reply, output);
+	reply += "}\n";
+}
+
+void appendRpcBadRequest(std::string& reply, const std::string& id, const std::string& problem)
+{
+	reply += "{\"id\":";
+	reply += id;
+	reply += ",\"ok\":false,\"error\":{\"code\":\"bad_request\",\"description\":";
+	appendString(reply, problem);
+	reply += "}}\n";
+}
+
+} // CLI
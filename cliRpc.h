@@ -0,0 +1,61 @@
+/*
+ * cliRpc.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLIRPC_H_
+#define CLIRPC_H_
+
+#include <string>
+
+#include "cliApi.h"
+#include "cliCommand.h"
+
+namespace CLI {
+
+	/*
+	 * JSON-lines protocol for automation clients. Every request is one line
+	 * holding an object, every response is one line too and carries the id
+	 * of its request. A client may send many requests before it reads the
+	 * responses, they come back in order.
+	 *
+	 *   {"id":7,"args":["show","vlan","10"]}
+	 *   {"id":8,"line":"show interface brief"}
+	 *
+	 *   {"id":7,"ok":true,"output":"..."}
+	 *   {"id":8,"ok":false,"error":{"code":"wrong_keyword","position":1,
+	 *       "token":"interfce","description":"interface"},"output":""}
+	 *
+	 * "args" are used as tokens as they are, "line" is split like a typed
+	 * line. The id may be any JSON number or string and is echoed as is.
+	 * A line which is not a request gets the error code "bad_request".
+	 */
+	struct RpcRequest
+	{
+		RpcRequest() : id("null") {}
+
+		std::string             id;     // JSON text of the id
+		BasicStringContainer_t  args;
+	};
+
+	/* Reads a request line, false with the reason if it is not one */
+	bool parseRpcRequest(const std::string& line, RpcRequest& request, std::string& problem);
+
+	/* Appends the response line of a command which ran */
+	void appendRpcResult(std::string& reply, const std::string& id, const std::string& output);
+
+	/*
+	 * Appends the response line of a rejected command. 'position' is the
+	 * index of the offending token in 'tokens'.
+	 */
+	void appendRpcError(std::string& reply, const std::string& id, const CommandError_t& cmdError,
+			const BasicStringContainer_t& tokens, size_t position, const std::string& output);
+
+	/* Appends the response line of a line which is not a request */
+	void appendRpcBadRequest(std::string& reply, const std::string& id, const std::string& problem);
+
+} // CLI
+
+#endif /* CLIRPC_H_ */
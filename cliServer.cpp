@@ -0,0 +1,571 @@
+/*
+ * cliServer.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "cliJobs.h"
+#include "cliRpc.h"
+#include "cliServer.h"
+
+namespace CLI {
+
+	extern bool stop_to_work;
+
+namespace {
+
+	const int MAX_EVENTS = 64;
+
+	/* Wake up period to check for the stop request, ms */
+	const int POLL_TIMEOUT = 500;
+
+	/* Same while a session waits for a job in the foreground, ms */
+	const int WAIT_POLL_TIMEOUT = 50;
+
+	const size_t READ_CHUNK = 4096;
+
+	/* A peer sending longer lines is disconnected */
+	const size_t MAX_LINE_LENGTH = 64 * 1024;
+
+	/* No lines are read from a peer leaving more output unread */
+	const size_t MAX_BACKLOG = 1024 * 1024;
+
+	/* Failed logins before a TCP peer is disconnected */
+	const unsigned MAX_LOGIN_ATTEMPTS = 3;
+
+	const int LISTEN_BACKLOG = 16;
+
+	const char USER_PROMPT[] = "Username: ";
+	const char PASSWORD_PROMPT[] = "Password: ";
+
+} // namespace
+
+SessionServer::SessionServer() :
+	epoll_(::epoll_create1(EPOLL_CLOEXEC)), stop_(false)
+{
+	// a peer going away must not kill the sessions of the others
+	::signal(SIGPIPE, SIG_IGN);
+}
+
+SessionServer::~SessionServer()
+{
+	while (!connections_.empty())
+		close(connections_.begin()->first);
+
+	for (std::vector<int>::const_iterator It = listeners_.begin(); It != listeners_.end(); ++It)
+		::close(*It);
+
+	for (BasicStringContainer_t::const_iterator It = unixPaths_.begin(); It != unixPaths_.end(); ++It)
+		::unlink(It->c_str());
+
+	::close(epoll_);
+}
+
+bool SessionServer::listenUnix(const std::string& path)
+{
+	return bindUnix(path) >= 0;
+}
+
+bool SessionServer::listenRpc(const std::string& path)
+{
+	int fd = bindUnix(path);
+	if (fd < 0)
+		return false;
+
+	rpcListeners_.push_back(fd);
+	return true;
+}
+
+int SessionServer::bindUnix(const std::string& path)
+{
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+
+	if (path.size() >= sizeof(addr.sun_path))
+		return -1;
+
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+	int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	::unlink(path.c_str());
+
+	if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+			::listen(fd, LISTEN_BACKLOG) < 0 || !addListener(fd))
+	{
+		::close(fd);
+		return -1;
+	}
+
+	unixPaths_.push_back(path);
+	return fd;
+}
+
+bool SessionServer::listenTcp(unsigned short port, const std::string& address)
+{
+	// a TCP peer is nobody until it logged in
+	if (!authenticate_)
+		return false;
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+
+	if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+		return false;
+
+	int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return false;
+
+	int on = 1;
+	::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+			::listen(fd, LISTEN_BACKLOG) < 0 || !addListener(fd))
+	{
+		::close(fd);
+		return false;
+	}
+
+	tcpListeners_.push_back(fd);
+	return true;
+}
+
+bool SessionServer::addListener(int fd)
+{
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+
+	event.events = EPOLLIN;
+	event.data.fd = fd;
+
+	if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) < 0)
+		return false;
+
+	listeners_.push_back(fd);
+	return true;
+}
+
+bool SessionServer::isListener(int fd) const
+{
+	return std::find(listeners_.begin(), listeners_.end(), fd) != listeners_.end();
+}
+
+void SessionServer::run()
+{
+	epoll_event events[MAX_EVENTS];
+
+	while (!stop_ && !stop_to_work)
+	{
+		bool waiting = false;
+		for (ConnectionStorageType_t::const_iterator It = connections_.begin(); !waiting && It != connections_.end(); ++It)
+			waiting = bool(It->second->session.waiting);
+
+		int count = ::epoll_wait(epoll_, events, MAX_EVENTS, waiting ? WAIT_POLL_TIMEOUT : POLL_TIMEOUT);
+
+		if (count < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		for (int i = 0; i < count; ++i)
+		{
+			int fd = events[i].data.fd;
+
+			if (isListener(fd))
+			{
+				accept(fd);
+				continue;
+			}
+
+			ConnectionStorageType_t::iterator It = connections_.find(fd);
+			if (It == connections_.end())
+				continue;
+
+			// keep the connection alive while its lines are executed
+			ConnectionPtr_t connection = It->second;
+
+			if (events[i].events & EPOLLOUT)
+			{
+				bool throttled = connection->wire().backlog() > MAX_BACKLOG;
+
+				if (!send(*connection))
+					continue;
+
+				// lines received before the peer fell behind
+				if (throttled && connection->wire().backlog() <= MAX_BACKLOG)
+					process(*connection);
+			}
+
+			if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+				receive(*connection);
+		}
+
+		resumeWaiting();
+	}
+}
+
+void SessionServer::accept(int listener)
+{
+	int fd = ::accept4(listener, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+
+	if (fd < 0)
+		return;
+
+	int on = 1;
+	::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.fd = fd;
+
+	if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) < 0)
+	{
+		::close(fd);
+		return;
+	}
+
+	ConnectionPtr_t connection(new Connection);
+	connection->fd = fd;
+	connection->rpc = std::find(rpcListeners_.begin(), rpcListeners_.end(), listener) != rpcListeners_.end();
+	connection->session.deferWait = true;
+	connections_[fd] = connection;
+
+	bool tcp = std::find(tcpListeners_.begin(), tcpListeners_.end(), listener) != tcpListeners_.end();
+
+	if (!tcp && !identify(*connection))
+	{
+		close(fd);
+		return;
+	}
+
+	if (connection->rpc)
+	{
+		// the output is captured into the responses
+		connection->session.output.setDescriptor(-1);
+		connection->reply.setDescriptor(fd);
+		return;
+	}
+
+	connection->session.output.setDescriptor(fd);
+
+	if (tcp)
+	{
+		connection->login = LOGIN_USER;
+		connection->session.output.flush(USER_PROMPT, sizeof(USER_PROMPT) - 1);
+		send(*connection);
+		return;
+	}
+
+	sendPrompt(*connection);
+	send(*connection);
+}
+
+/* Identity of a Unix socket peer, the default one without the hook */
+bool SessionServer::identify(Connection& connection)
+{
+	if (!identify_)
+		return true;
+
+	ucred credentials;
+	socklen_t length = sizeof(credentials);
+
+	if (::getsockopt(connection.fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) < 0)
+		return false;
+
+	return identify_(credentials.uid, credentials.gid, connection.session);
+}
+
+void SessionServer::receive(Connection& connection)
+{
+	char buffer[READ_CHUNK];
+
+	ssize_t length = ::read(connection.fd, buffer, sizeof(buffer));
+
+	if (length < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+		return;
+
+	if (length <= 0)
+	{
+		close(connection.fd);
+		return;
+	}
+
+	connection.input.append(buffer, length);
+
+	process(connection);
+}
+
+/*
+ * Runs the complete lines received so far. A session waiting for a job
+ * keeps its lines until resumeWaiting().
+ */
+void SessionServer::process(Connection& connection)
+{
+	std::string::size_type begin = 0;
+	std::string::size_type end;
+
+	while (!connection.session.waiting && connection.wire().backlog() <= MAX_BACKLOG &&
+			(end = connection.input.find('\n', begin)) != std::string::npos)
+	{
+		std::string line(connection.input, begin, end - begin);
+		begin = end + 1;
+
+		if (!line.empty() && line[line.size() - 1] == '\r')
+			line.erase(line.size() - 1);
+
+		if (connection.rpc)
+			call(connection, line);
+		else if (connection.login != LOGGED_IN)
+		{
+			login(connection, line);
+
+			if (connection.fd < 0)
+				return;
+		}
+		else
+		{
+			execute(connection, line);
+
+			if (!connection.session.waiting)
+				sendPrompt(connection);
+		}
+	}
+
+	connection.input.erase(0, begin);
+
+	if (connection.input.size() > MAX_LINE_LENGTH)
+	{
+		close(connection.fd);
+		return;
+	}
+
+	// pipelined requests are answered in one write
+	if (connection.rpc && !connection.reply.flush())
+	{
+		close(connection.fd);
+		return;
+	}
+
+	send(connection);
+}
+
+void SessionServer::execute(Connection& connection, const std::string& line)
+{
+	executeLine(connection.session, line);
+}
+
+void SessionServer::login(Connection& connection, const std::string& line)
+{
+	OutputSink& output = connection.session.output;
+
+	if (connection.login == LOGIN_USER)
+	{
+		connection.user = line;
+		connection.login = LOGIN_PASSWORD;
+		output.flush(PASSWORD_PROMPT, sizeof(PASSWORD_PROMPT) - 1);
+		return;
+	}
+
+	if (authenticate_ && authenticate_(connection.user, line, connection.session))
+	{
+		connection.login = LOGGED_IN;
+		connection.user.clear();
+		sendPrompt(connection);
+		return;
+	}
+
+	if (++connection.attempts >= MAX_LOGIN_ATTEMPTS)
+	{
+		output.stream() << TR("Login incorrect") << '\n';
+		output.flush();
+		close(connection.fd);
+		return;
+	}
+
+	connection.login = LOGIN_USER;
+	output.stream() << TR("Login incorrect") << '\n';
+	output.flush(USER_PROMPT, sizeof(USER_PROMPT) - 1);
+}
+
+void SessionServer::call(Connection& connection, const std::string& line)
+{
+	RpcRequest request;
+	std::string problem;
+	std::string response;
+
+	if (!parseRpcRequest(line, request, problem))
+	{
+		appendRpcBadRequest(response, request.id, problem);
+		connection.reply.stream() << response;
+		return;
+	}
+
+	Session& session = connection.session;
+	CommandError_t cmdError;
+	bool executed;
+
+	// what the command writes to the session becomes part of the response
+	std::stringbuf captured;
+	std::ostream& out = session.output.stream();
+	std::streambuf* previous = out.rdbuf(&captured);
+
+	executed = executeCommand(session, request.args, cmdError);
+	JobManager::Instance().flush(&session, out);
+
+	out.rdbuf(previous);
+
+	// 'fg' is answered by answerWaiting() once the job finished
+	if (session.waiting)
+	{
+		connection.pendingId = request.id;
+		connection.pendingOutput = captured.str();
+		return;
+	}
+
+	if (executed)
+		appendRpcResult(response, request.id, captured.str());
+	else
+		appendRpcError(response, request.id, cmdError, request.args,
+				cmdError.position - session.tokens.begin(), captured.str());
+
+	connection.reply.stream() << response;
+}
+
+void SessionServer::answerWaiting(Connection& connection)
+{
+	std::ostringstream out;
+	JobManager::Instance().flush(&connection.session, out);
+
+	std::string response;
+	appendRpcResult(response, connection.pendingId, connection.pendingOutput + out.str());
+
+	connection.reply.stream() << response;
+
+	connection.pendingId.clear();
+	connection.pendingOutput.clear();
+}
+
+void SessionServer::sendPrompt(Connection& connection)
+{
+	OutputSink& output = connection.session.output;
+
+	JobManager::Instance().flush(&connection.session, output.stream());
+
+	// the output of the line and the prompt go out in one writev
+	std::string prompt = sessionPrompt(connection.session);
+	output.flush(prompt.data(), prompt.size());
+}
+
+/*
+ * Writes what the peer takes and watches for it to take more, a peer
+ * too far behind is not read from meanwhile. Returns false if the
+ * connection was closed.
+ */
+bool SessionServer::send(Connection& connection)
+{
+	OutputSink& wire = connection.wire();
+
+	if (!wire.drain())
+	{
+		close(connection.fd);
+		return false;
+	}
+
+	uint32_t events = wire.backlog() > MAX_BACKLOG ? 0 : EPOLLIN | EPOLLRDHUP;
+
+	if (wire.backlog() > 0)
+		events |= EPOLLOUT;
+
+	if (events != connection.events)
+	{
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+
+		event.events = events;
+		event.data.fd = connection.fd;
+
+		::epoll_ctl(epoll_, EPOLL_CTL_MOD, connection.fd, &event);
+		connection.events = events;
+	}
+
+	return true;
+}
+
+/*
+ * Sessions whose foreground job has finished get its output and the
+ * prompt, and go on with the lines they received meanwhile
+ */
+void SessionServer::resumeWaiting()
+{
+	std::vector<ConnectionPtr_t> resumed;
+
+	for (ConnectionStorageType_t::const_iterator It = connections_.begin(); It != connections_.end(); ++It)
+	{
+		const JobPtr_t& job = It->second->session.waiting;
+
+		if (job && job->finished())
+			resumed.push_back(It->second);
+	}
+
+	for (std::vector<ConnectionPtr_t>::const_iterator It = resumed.begin(); It != resumed.end(); ++It)
+	{
+		Connection& connection = **It;
+
+		connection.session.waiting.reset();
+
+		if (connection.rpc)
+			answerWaiting(connection);
+		else
+			sendPrompt(connection);
+
+		process(connection);
+	}
+}
+
+void SessionServer::close(int fd)
+{
+	ConnectionStorageType_t::iterator It = connections_.find(fd);
+	if (It != connections_.end())
+	{
+		Connection& connection = *It->second;
+
+		JobManager::Instance().release(&connection.session);
+		connection.session.waiting.reset();
+		connection.session.output.setDescriptor(-1);
+		connection.reply.setDescriptor(-1);
+		connection.fd = -1;
+	}
+
+	::epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, NULL);
+	::close(fd);
+
+	connections_.erase(fd);
+}
+
+} // CLI
@@ -0,0 +1,156 @@
+/*
+ * cliServer.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLISERVER_H_
+#define CLISERVER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/epoll.h>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "cliSession.h"
+
+namespace CLI {
+
+	/*
+	 * Checks the credentials of a peer. On success it sets the user and
+	 * groups of the session and returns true.
+	 */
+	typedef boost::function<bool (const std::string& user, const std::string& password,
+			Session& session)> Authenticate_t;
+
+	/*
+	 * Sets the user and groups of the session of a Unix socket peer from
+	 * the credentials of its process. Returns false to refuse the peer.
+	 */
+	typedef boost::function<bool (uid_t uid, gid_t gid, Session& session)> Identify_t;
+
+	/*
+	 * Serves many CLI sessions from one process.
+	 *
+	 * Every accepted connection gets its own Session, lines are read in an
+	 * epoll loop and executed one at a time by the shared engine, with
+	 * command output going back to the connection. A line ending with '?'
+	 * prints context help. The session ends when the peer closes the
+	 * connection.
+	 *
+	 * Connections are non-blocking. Output a peer does not read is kept
+	 * per connection and sent when the peer is ready again, no further
+	 * lines of a peer falling too far behind are read until it caught
+	 * up. 'fg' does not hold up the loop: the lines following it wait
+	 * until the job has finished.
+	 *
+	 * TCP peers log in first with user name and password, checked by the
+	 * authentication hook, and get no group before. Unix sockets, RPC ones
+	 * included, are guarded by their file permissions. Their peers get the
+	 * identity the identification hook gives them from the credentials of
+	 * the peer process; without the hook every one of them keeps the user
+	 * and group of a new Session, the identity the server itself runs
+	 * commands with.
+	 *
+	 * Connections to an RPC listener speak the JSON-lines protocol of
+	 * cliRpc.h instead: no prompt, one response per request, and the
+	 * responses to all requests read at once are sent in one write.
+	 * Only output written to commandOutput() is part of a response. The
+	 * response to 'fg' is sent once the job finished, the requests after
+	 * it wait for it.
+	 */
+	class SessionServer
+	{
+		public:
+			SessionServer();
+			~SessionServer();
+
+			/* Required before listenTcp() */
+			void setAuthentication(const Authenticate_t& authenticate) { authenticate_ = authenticate; }
+
+			/* For Unix socket peers, to be set before run() */
+			void setIdentification(const Identify_t& identify) { identify_ = identify; }
+
+			bool listenUnix(const std::string& path);
+			bool listenTcp(unsigned short port, const std::string& address = "127.0.0.1");
+			bool listenRpc(const std::string& path);
+
+			/* Serves connections until stop() or CLI::stop_to_work */
+			void run();
+			void stop() { stop_ = true; }
+
+		private:
+			enum LoginState_t
+			{
+				LOGIN_USER,
+				LOGIN_PASSWORD,
+				LOGGED_IN
+			};
+
+			struct Connection
+			{
+				Connection() : fd(-1), rpc(false), login(LOGGED_IN), attempts(0), events(EPOLLIN | EPOLLRDHUP) {}
+
+				int          fd;
+				bool         rpc;
+				Session      session;
+				std::string  input;
+
+				LoginState_t login;
+				std::string  user;
+				unsigned     attempts;
+
+				/* Responses of an RPC connection, its session output is captured */
+				OutputSink   reply;
+
+				/* RPC request whose 'fg' waits for the job, and its output so far */
+				std::string  pendingId;
+				std::string  pendingOutput;
+
+				/* Watched epoll events, EPOLLOUT while output is pending */
+				uint32_t     events;
+
+				OutputSink& wire() { return rpc ? reply : session.output; }
+			};
+
+			typedef boost::shared_ptr<Connection>    ConnectionPtr_t;
+			typedef std::map<int, ConnectionPtr_t>   ConnectionStorageType_t;
+
+			int bindUnix(const std::string& path);
+			bool addListener(int fd);
+			void accept(int listener);
+			void receive(Connection& connection);
+			void process(Connection& connection);
+			void execute(Connection& connection, const std::string& line);
+			void login(Connection& connection, const std::string& line);
+			void call(Connection& connection, const std::string& line);
+			void answerWaiting(Connection& connection);
+			bool identify(Connection& connection);
+			void sendPrompt(Connection& connection);
+			bool send(Connection& connection);
+			void resumeWaiting();
+			void close(int fd);
+
+			bool isListener(int fd) const;
+
+			int                     epoll_;
+			std::vector<int>        listeners_;
+			std::vector<int>        rpcListeners_;
+			std::vector<int>        tcpListeners_;
+			BasicStringContainer_t  unixPaths_;
+			ConnectionStorageType_t connections_;
+			Authenticate_t          authenticate_;
+			Identify_t              identify_;
+			bool                    stop_;
+	};
+
+} // CLI
+
+#endif /* CLISERVER_H_ */
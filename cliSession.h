@@ -0,0 +1,119 @@
+/*
+ * cliSession.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLISESSION_H_
+#define CLISESSION_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "cliApi.h"
+#include "cliArena.h"
+#include "cliCommand.h"
+#include "cliCommandIndex.h"
+#include "cliJobs.h"
+#include "cliOutput.h"
+#include "cliTransaction.h"
+#include "adtauth.h"
+
+namespace CLI {
+
+	/*
+	 * State of one operator session.
+	 *
+	 * The command registry (Engine::commands() and its index) is shared by
+	 * all sessions and is not changed by processing a line. Everything a line
+	 * being processed does touch lives here, so one process can serve many
+	 * sessions by switching between them.
+	 */
+	struct Session
+	{
+		Session();
+
+		/* Number of the session in this process, for logs */
+		unsigned                id;
+
+		BasicStringContainer_t  tokens;
+
+		/* '|' and the output filters following the command */
+		BasicStringContainer_t  filter;
+
+		ParameterStorageType_t  paramStorage;
+		BasicStringContainer_t  contextHelp;
+
+		/* Tokens with abbreviated keywords written out */
+		BasicStringContainer_t  expanded;
+
+		AdtAuth::AdtGroup       group;
+		AdtAuth::AdtUser        user;
+
+		/* Further groups the user is a member of */
+		BasicStringContainer_t  groups;
+
+		/* Bits of group and groups, kept by the engine */
+		GroupMask_t             permissions;
+		std::string             permissionsGroup;
+		size_t                  permissionsCount;
+
+		Context_t               context;
+
+		/* Line to put back into the prompt after context help */
+		std::string             cmdText;
+
+		/* Executed lines, readline keeps the history of the console */
+		BasicStringContainer_t  history;
+
+		/* Engine temporaries of the line being processed */
+		Arena                   arena;
+
+		/* Output to the terminal or peer, flushed at the prompt */
+		OutputSink              output;
+
+		/*
+		 * Set by a server which must not block: 'fg' leaves the job in
+		 * 'waiting' instead of waiting for it
+		 */
+		bool                    deferWait;
+		JobPtr_t                waiting;
+
+		/* Configuration changes staged by 'configure batch' */
+		ConfigTransaction       transaction;
+	};
+
+	typedef boost::shared_ptr<Session> SessionPtr_t;
+
+	/* Session of the operator on the controlling terminal */
+	Session& consoleSession();
+
+	/* Session the engine is working for */
+	Session& currentSession();
+
+	/*
+	 * Processes one command line on behalf of the session. Output is kept
+	 * in session.output until its next flush. A line ending with '?'
+	 * prints context help, a line ending with '&' runs as a background job.
+	 * Output filters may follow the command, see OutputFilter.
+	 * Returns false if the line was rejected or a batch command failed.
+	 */
+	bool executeLine(Session& session, const std::string& line);
+
+	/*
+	 * Runs the command accepting the tokens, for clients which split the
+	 * line themselves. On rejection cmdError.position refers to
+	 * session.tokens, which hold a copy of the tokens. A batch command
+	 * which failed, such as a 'commit' a backend refused, is rejected too.
+	 */
+	bool executeCommand(Session& session, const BasicStringContainer_t& tokens, CommandError_t& cmdError);
+
+	/* Prompt of the context the session is in */
+	std::string sessionPrompt(Session& session);
+
+} // CLI
+
+#endif /* CLISESSION_H_ */
@@ -0,0 +1,440 @@
+/*
+ * cliStatistics.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <time.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "cliCommand.h"
+#include "cliCommandIndex.h"
+#include "cliJobs.h"
+#include "cliStatistics.h"
+
+namespace CLI {
+
+namespace {
+
+	const char* STAGE_NAMES[CLI_STAGE_COUNT] = { "tokenize", "lookup", "lock wait", "execute" };
+	const char* STAGE_KEYS[CLI_STAGE_COUNT]  = { "tokenize", "lookup", "lock_wait", "execute" };
+
+	const double PERCENTILES[] = { 50.0, 90.0, 99.0 };
+	const size_t PERCENTILE_COUNT = sizeof(PERCENTILES) / sizeof(PERCENTILES[0]);
+
+	/* Floor of log2, value > 0 */
+	unsigned magnitude(boost::uint64_t value)
+	{
+		return 63 - __builtin_clzll(value);
+	}
+
+	/* Microseconds with one decimal for the table */
+	std::string micro(boost::uint64_t nanoseconds)
+	{
+		std::ostringstream result;
+		result << std::fixed << std::setprecision(1) << nanoseconds / 1000.0;
+		return result.str();
+	}
+
+	std::string escape(const std::string& text)
+	{
+		std::string result;
+
+		for (std::string::const_iterator It = text.begin(); It != text.end(); ++It)
+		{
+			if (*It == '"' || *It == '\\')
+				result += '\\';
+			result += *It;
+		}
+
+		return result;
+	}
+
+	void printRow(std::ostream& out, const std::string& name, boost::uint64_t count, const LatencyHistogram& histogram)
+	{
+		out << std::left << std::setw(32) << name << std::right << std::setw(12) << count;
+
+		for (size_t i = 0; i < PERCENTILE_COUNT; ++i)
+			out << std::setw(10) << micro(histogram.percentile(PERCENTILES[i]));
+
+		out << std::setw(10) << micro(histogram.max()) << '\n';
+	}
+
+	void dumpHistogram(std::ostream& out, const LatencyHistogram& histogram)
+	{
+		for (size_t i = 0; i < PERCENTILE_COUNT; ++i)
+			out << ",\"p" << PERCENTILES[i] << "\":" << histogram.percentile(PERCENTILES[i]);
+
+		out << ",\"max\":" << histogram.max();
+	}
+
+	bool busier(const boost::shared_ptr<CommandStatistics>& left, const boost::shared_ptr<CommandStatistics>& right)
+	{
+		return left->totalTime() > right->totalTime();
+	}
+
+	/* 'show cli statistics', 'show cli statistics json' and 'clear cli statistics' */
+	class StatisticsCommand : public Command
+	{
+		public:
+			enum Action_t
+			{
+				SHOW,
+				DUMP,
+				CLEAR
+			};
+
+			explicit StatisticsCommand(Action_t action) :
+				action_(action)
+			{
+				keywords_.push_back(action == CLEAR ? "clear" : "show");
+				keywords_.push_back("cli");
+				keywords_.push_back("statistics");
+
+				if (action == DUMP)
+					keywords_.push_back("json");
+			}
+
+			bool validate(const std::vector<std::string>& tokens, ParameterStorageType_t& /* params */, CommandError_t& error)
+			{
+				size_t matched = matchKeywords(tokens);
+
+				if (matched < keywords_.size())
+				{
+					error.error = matched == tokens.size() ? CLI_CMD_SHORT : CLI_CMD_WRONG_KEYWORD;
+					error.position = tokens.begin() + matched;
+					return false;
+				}
+
+				if (tokens.size() > keywords_.size())
+				{
+					error.error = CLI_CMD_TOO_LONG;
+					error.position = tokens.begin() + keywords_.size();
+					return false;
+				}
+
+				return true;
+			}
+
+			void getContextHelp(const std::vector<std::string>& tokens, std::vector<std::string>& help)
+			{
+				size_t matched = matchKeywords(tokens);
+
+				if (matched == tokens.size() && matched < keywords_.size())
+					help.push_back(keywords_[matched] + "    " + keywordHelp(matched));
+			}
+
+			char* completion(bool /* get */, const std::vector<std::string>& /* tokens */, int& /* startWithIndex */)
+			{
+				return NULL;
+			}
+
+			void execute(const ParameterStorageType_t& /* params */, const std::string& /* group */)
+			{
+				switch (action_)
+				{
+				case SHOW:
+					Statistics::Instance().print(commandOutput());
+					break;
+				case DUMP:
+					Statistics::Instance().dump(commandOutput());
+					break;
+				case CLEAR:
+					Statistics::Instance().clear();
+					break;
+				}
+			}
+
+		private:
+			/* Keywords come written out, the engine expands abbreviations */
+			size_t matchKeywords(const std::vector<std::string>& tokens) const
+			{
+				size_t i = 0;
+				while (i < keywords_.size() && i < tokens.size() && keywords_[i] == tokens[i])
+					++i;
+
+				return i;
+			}
+
+			std::string keywordHelp(size_t index) const
+			{
+				switch (index)
+				{
+				case 0:
+					return action_ == CLEAR ? TR("Clear information") : TR("Show information");
+				case 1:
+					return TR("Command line interface");
+				case 2:
+					return TR("Command latency statistics");
+				default:
+					return TR("As JSON");
+				}
+			}
+
+			Action_t               action_;
+			BasicStringContainer_t keywords_;
+	};
+
+} // namespace
+
+/*****************************************************************************/
+/*                           LatencyHistogram                                */
+/*****************************************************************************/
+LatencyHistogram::LatencyHistogram()
+{
+	clear();
+}
+
+size_t LatencyHistogram::bucket(boost::uint64_t nanoseconds)
+{
+	if (nanoseconds < (1ULL << MIN_MAGNITUDE))
+		return 0;
+
+	unsigned order = magnitude(nanoseconds);
+
+	if (order > MAX_MAGNITUDE)
+		return BUCKETS - 1;
+
+	size_t sub = (nanoseconds >> (order - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+	return (order - MIN_MAGNITUDE) * SUB_BUCKETS + sub;
+}
+
+boost::uint64_t LatencyHistogram::upperBound(size_t bucket)
+{
+	unsigned order = MIN_MAGNITUDE + bucket / SUB_BUCKETS;
+	boost::uint64_t step = 1ULL << (order - SUB_BUCKET_BITS);
+
+	return (1ULL << order) + (bucket % SUB_BUCKETS + 1) * step - 1;
+}
+
+void LatencyHistogram::record(boost::uint64_t nanoseconds)
+{
+	buckets_[bucket(nanoseconds)].fetch_add(1, boost::memory_order_relaxed);
+
+	boost::uint64_t current = max_.load(boost::memory_order_relaxed);
+	while (nanoseconds > current &&
+			!max_.compare_exchange_weak(current, nanoseconds, boost::memory_order_relaxed))
+		;
+}
+
+void LatencyHistogram::clear()
+{
+	for (size_t i = 0; i < BUCKETS; ++i)
+		buckets_[i].store(0, boost::memory_order_relaxed);
+
+	max_.store(0, boost::memory_order_relaxed);
+}
+
+boost::uint64_t LatencyHistogram::count() const
+{
+	boost::uint64_t result = 0;
+
+	for (size_t i = 0; i < BUCKETS; ++i)
+		result += buckets_[i].load(boost::memory_order_relaxed);
+
+	return result;
+}
+
+boost::uint64_t LatencyHistogram::max() const
+{
+	return max_.load(boost::memory_order_relaxed);
+}
+
+boost::uint64_t LatencyHistogram::percentile(double percent) const
+{
+	boost::uint64_t total = count();
+
+	if (total == 0)
+		return 0;
+
+	boost::uint64_t rank = static_cast<boost::uint64_t>(total * percent / 100.0 + 0.5);
+	if (rank == 0)
+		rank = 1;
+
+	boost::uint64_t seen = 0;
+
+	for (size_t i = 0; i < BUCKETS; ++i)
+	{
+		seen += buckets_[i].load(boost::memory_order_relaxed);
+
+		if (seen >= rank)
+			return std::min(upperBound(i), max());
+	}
+
+	return max();
+}
+
+/*****************************************************************************/
+/*                          CommandStatistics                                */
+/*****************************************************************************/
+CommandStatistics::CommandStatistics(const std::string& name) :
+	name_(name), calls_(0), totalTime_(0), execute_(NULL)
+{
+}
+
+CommandStatistics::~CommandStatistics()
+{
+	delete execute_.load();
+}
+
+void CommandStatistics::record(boost::uint64_t nanoseconds)
+{
+	LatencyHistogram* histogram = execute_.load(boost::memory_order_acquire);
+
+	if (histogram == NULL)
+	{
+		LatencyHistogram* created = new LatencyHistogram;
+
+		// another thread may have been first
+		if (execute_.compare_exchange_strong(histogram, created, boost::memory_order_acq_rel))
+			histogram = created;
+		else
+			delete created;
+	}
+
+	histogram->record(nanoseconds);
+
+	calls_.fetch_add(1, boost::memory_order_relaxed);
+	totalTime_.fetch_add(nanoseconds, boost::memory_order_relaxed);
+}
+
+void CommandStatistics::clear()
+{
+	calls_.store(0, boost::memory_order_relaxed);
+	totalTime_.store(0, boost::memory_order_relaxed);
+
+	LatencyHistogram* histogram = execute_.load(boost::memory_order_acquire);
+	if (histogram)
+		histogram->clear();
+}
+
+/*****************************************************************************/
+/*                              Statistics                                   */
+/*****************************************************************************/
+Statistics::Statistics() :
+	rejected_(0)
+{
+}
+
+Statistics& Statistics::Instance()
+{
+	static Statistics instance;
+	return instance;
+}
+
+boost::uint64_t Statistics::now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return static_cast<boost::uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+CommandStatistics* Statistics::attach(const void* command, const std::string& name)
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	CommandStatisticsPtr_t& result = commands_[command];
+	if (!result)
+		result.reset(new CommandStatistics(name));
+
+	return result.get();
+}
+
+void Statistics::commands(CommandStatisticsStorageType_t& result) const
+{
+	boost::mutex::scoped_lock lock(sync_);
+
+	for (CommandStatisticsIndexType_t::const_iterator It = commands_.begin(); It != commands_.end(); ++It)
+	{
+		if (It->second->calls() > 0 && It->second->execute())
+			result.push_back(It->second);
+	}
+}
+
+void Statistics::print(std::ostream& out) const
+{
+	out << std::left << std::setw(32) << "Stage" << std::right << std::setw(12) << "Count"
+		<< std::setw(10) << "p50 us" << std::setw(10) << "p90 us" << std::setw(10) << "p99 us"
+		<< std::setw(10) << "max us" << '\n';
+
+	for (size_t i = 0; i < CLI_STAGE_COUNT; ++i)
+		printRow(out, STAGE_NAMES[i], stages_[i].count(), stages_[i]);
+
+	out << '\n' << "Rejected lines: " << rejected_.load(boost::memory_order_relaxed) << '\n';
+
+	CommandStatisticsStorageType_t used;
+	commands(used);
+
+	if (used.empty())
+		return;
+
+	std::sort(used.begin(), used.end(), busier);
+
+	out << '\n' << std::left << std::setw(32) << "Command" << std::right << std::setw(12) << "Calls"
+		<< std::setw(10) << "p50 us" << std::setw(10) << "p90 us" << std::setw(10) << "p99 us"
+		<< std::setw(10) << "max us" << '\n';
+
+	for (CommandStatisticsStorageType_t::const_iterator It = used.begin(); It != used.end(); ++It)
+		printRow(out, (*It)->name(), (*It)->calls(), *(*It)->execute());
+}
+
+/*
+ * One JSON object on a line, times in nanoseconds
+ */
+void Statistics::dump(std::ostream& out) const
+{
+	out << "{\"stages\":{";
+
+	for (size_t i = 0; i < CLI_STAGE_COUNT; ++i)
+	{
+		out << (i ? "," : "") << "\"" << STAGE_KEYS[i] << "\":{\"count\":" << stages_[i].count();
+		dumpHistogram(out, stages_[i]);
+		out << "}";
+	}
+
+	out << "},\"rejected\":" << rejected_.load(boost::memory_order_relaxed) << ",\"commands\":[";
+
+	CommandStatisticsStorageType_t used;
+	commands(used);
+	std::sort(used.begin(), used.end(), busier);
+
+	for (CommandStatisticsStorageType_t::const_iterator It = used.begin(); It != used.end(); ++It)
+	{
+		out << (It == used.begin() ? "" : ",") << "{\"name\":\"" << escape((*It)->name())
+			<< "\",\"calls\":" << (*It)->calls() << ",\"total\":" << (*It)->totalTime();
+		dumpHistogram(out, *(*It)->execute());
+		out << "}";
+	}
+
+	out << "]}" << '\n';
+}
+
+void Statistics::clear()
+{
+	for (size_t i = 0; i < CLI_STAGE_COUNT; ++i)
+		stages_[i].clear();
+
+	rejected_.store(0, boost::memory_order_relaxed);
+
+	boost::mutex::scoped_lock lock(sync_);
+
+	for (CommandStatisticsIndexType_t::const_iterator It = commands_.begin(); It != commands_.end(); ++It)
+		It->second->clear();
+}
+
+void registerStatisticsCommands(securityHook hook, Context_t context)
+{
+	ModulePtr_t module = createModule("cli statistics", TR("Command line statistics"), context);
+
+	registerCommand(module, CommandPtr_t(new StatisticsCommand(StatisticsCommand::SHOW)), hook, context, CLI_ACCESS_SHARED);
+	registerCommand(module, CommandPtr_t(new StatisticsCommand(StatisticsCommand::DUMP)), hook, context, CLI_ACCESS_SHARED);
+	registerCommand(module, CommandPtr_t(new StatisticsCommand(StatisticsCommand::CLEAR)), hook, context, CLI_ACCESS_EXCLUSIVE);
+}
+
+} // CLI
@@ -0,0 +1,176 @@
+/*
+ * cliStatistics.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLISTATISTICS_H_
+#define CLISTATISTICS_H_
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "cliApi.h"
+
+namespace CLI {
+
+	/*
+	 * Latency histogram with logarithmic buckets split into linear
+	 * sub-buckets (HDR style): values from 64 ns to about a minute are
+	 * kept with 1/8 relative precision. Recording is a relaxed atomic
+	 * increment, and a compare and swap when the maximum grows.
+	 */
+	class LatencyHistogram
+	{
+		public:
+			enum
+			{
+				SUB_BUCKET_BITS = 3,
+				SUB_BUCKETS     = 1 << SUB_BUCKET_BITS,
+				MIN_MAGNITUDE   = 6,    // 64 ns
+				MAX_MAGNITUDE   = 36,   // 68 s
+				BUCKETS         = (MAX_MAGNITUDE - MIN_MAGNITUDE + 1) * SUB_BUCKETS
+			};
+
+			LatencyHistogram();
+
+			void record(boost::uint64_t nanoseconds);
+			void clear();
+
+			boost::uint64_t count() const;
+			boost::uint64_t max() const;
+
+			/* Upper bound of the bucket holding the given percentile, ns */
+			boost::uint64_t percentile(double percent) const;
+
+		private:
+			static size_t bucket(boost::uint64_t nanoseconds);
+			static boost::uint64_t upperBound(size_t bucket);
+
+			boost::atomic<boost::uint32_t> buckets_[BUCKETS];
+			boost::atomic<boost::uint64_t> max_;
+	};
+
+	/*
+	 * Counters of one registered command. Most commands of a large
+	 * registry are never run, their histogram is allocated on first use.
+	 */
+	class CommandStatistics
+	{
+		public:
+			explicit CommandStatistics(const std::string& name);
+			~CommandStatistics();
+
+			const std::string& name() const { return name_; }
+
+			void record(boost::uint64_t nanoseconds);
+			void clear();
+
+			boost::uint64_t calls() const { return calls_.load(boost::memory_order_relaxed); }
+			boost::uint64_t totalTime() const { return totalTime_.load(boost::memory_order_relaxed); }
+
+			/* NULL until the command has run */
+			const LatencyHistogram* execute() const { return execute_.load(boost::memory_order_acquire); }
+
+		private:
+			CommandStatistics(const CommandStatistics&);
+			CommandStatistics& operator=(const CommandStatistics&);
+
+			const std::string                 name_;
+			boost::atomic<boost::uint64_t>    calls_;
+			boost::atomic<boost::uint64_t>    totalTime_;   // ns
+			boost::atomic<LatencyHistogram*>  execute_;
+	};
+
+	/* Stages of processing a command line */
+	enum Stage_t
+	{
+		CLI_STAGE_TOKENIZE,
+		CLI_STAGE_LOOKUP,
+		CLI_STAGE_LOCK_WAIT,
+		CLI_STAGE_EXECUTE,
+		CLI_STAGE_COUNT
+	};
+
+	/*
+	 * Engine wide dispatch statistics, shown by 'show cli statistics' and
+	 * dumped as JSON by 'show cli statistics json'
+	 */
+	class Statistics
+	{
+		public:
+			static Statistics& Instance();
+
+			/*
+			 * Counters of a command being registered, owned by Statistics.
+			 * A command indexed again gets its counters back.
+			 */
+			CommandStatistics* attach(const void* command, const std::string& name);
+
+			void record(Stage_t stage, boost::uint64_t nanoseconds)
+			{
+				stages_[stage].record(nanoseconds);
+			}
+
+			void rejected() { rejected_.fetch_add(1, boost::memory_order_relaxed); }
+
+			void print(std::ostream& out) const;
+			void dump(std::ostream& out) const;
+			void clear();
+
+			/* Monotonic time, ns */
+			static boost::uint64_t now();
+
+		private:
+			Statistics();
+
+			typedef boost::shared_ptr<CommandStatistics>         CommandStatisticsPtr_t;
+			typedef std::vector<CommandStatisticsPtr_t>          CommandStatisticsStorageType_t;
+			typedef std::map<const void*, CommandStatisticsPtr_t> CommandStatisticsIndexType_t;
+
+			void commands(CommandStatisticsStorageType_t& result) const;
+
+			LatencyHistogram               stages_[CLI_STAGE_COUNT];
+			boost::atomic<boost::uint64_t> rejected_;
+
+			mutable boost::mutex         sync_;
+			CommandStatisticsIndexType_t commands_;
+	};
+
+	/* Adds the time since it was created to a stage */
+	class StageTimer
+	{
+		public:
+			explicit StageTimer(Stage_t stage) :
+				stage_(stage), start_(Statistics::now())
+			{}
+
+			~StageTimer()
+			{
+				Statistics::Instance().record(stage_, Statistics::now() - start_);
+			}
+
+		private:
+			Stage_t         stage_;
+			boost::uint64_t start_;
+	};
+
+	/*
+	 * Registers 'show cli statistics [json]' and 'clear cli statistics'
+	 * for the groups 'hook' lets in, like any other command. The engine
+	 * registers no commands of its own: main() calls this once, next to
+	 * its other registrations, or the commands do not exist.
+	 */
+	void registerStatisticsCommands(securityHook hook, Context_t context = CLI_CTX_NORMAL);
+
+} // CLI
+
+#endif /* CLISTATISTICS_H_ */
@@ -0,0 +1,333 @@
+/*
+ * cliTokenizer.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <boost/lexical_cast.hpp>
+
+#include "cliTokenizer.h"
+
+namespace CLI {
+
+namespace {
+
+	/* Lines shorter than this are scanned byte by byte */
+	const size_t SIMD_THRESHOLD = 64;
+
+	/* Typical number of words in a line */
+	const size_t TOKENS_RESERVED = 32;
+
+	/* Same set as isspace() in the "C" locale */
+	inline bool isSpace (char c)
+	{
+		return c == ' ' || (static_cast<unsigned char>(c) - '\t') <= ('\r' - '\t');
+	}
+
+#ifdef __SSE2__
+	/* Bitmask of white spaces in 16 bytes starting at p */
+	inline unsigned spaceMask (const char* p)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+		__m128i spaces = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')),
+						_mm_cmpeq_epi8(block, _mm_set1_epi8('\t'))),
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')),
+						_mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))));
+
+		spaces = _mm_or_si128(spaces,
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\v')),
+						_mm_cmpeq_epi8(block, _mm_set1_epi8('\f'))));
+
+		return static_cast<unsigned>(_mm_movemask_epi8(spaces));
+	}
+#endif
+
+	/* First white space in [p, end) */
+	const char* findSpace (const char* p, const char* end, bool wide)
+	{
+#ifdef __SSE2__
+		if (wide)
+		{
+			for (; end - p >= 16; p += 16)
+			{
+				unsigned mask = spaceMask(p);
+				if (mask != 0)
+					return p + __builtin_ctz(mask);
+			}
+		}
+#endif
+		while (p != end && !isSpace(*p))
+			++p;
+
+		return p;
+	}
+
+	/* First non white space in [p, end) */
+	const char* skipSpace (const char* p, const char* end, bool wide)
+	{
+#ifdef __SSE2__
+		if (wide)
+		{
+			for (; end - p >= 16; p += 16)
+			{
+				unsigned mask = ~spaceMask(p) & 0xFFFF;
+				if (mask != 0)
+					return p + __builtin_ctz(mask);
+			}
+		}
+#endif
+		while (p != end && isSpace(*p))
+			++p;
+
+		return p;
+	}
+
+	/* "<first>-<last>" of decimal numbers */
+	bool numberRange(const std::string& element, unsigned long& first, unsigned long& last)
+	{
+		size_t dash = element.find('-');
+
+		if (dash == 0 || dash == std::string::npos || dash + 1 == element.size() ||
+				element.find_first_not_of("0123456789") != dash ||
+				element.find_first_not_of("0123456789", dash + 1) != std::string::npos)
+			return false;
+
+		first = strtoul(element.c_str(), NULL, 10);
+		last = strtoul(element.c_str() + dash + 1, NULL, 10);
+
+		return true;
+	}
+
+	/*
+	 * Elements of a "{...}" list, false if the text is no list. Stops
+	 * once there are more than 'limit'.
+	 */
+	bool listElements(const std::string& text, size_t limit, BasicStringContainer_t& elements)
+	{
+		elements.clear();
+
+		bool list = false;
+		size_t begin = 0;
+
+		for (;;)
+		{
+			size_t end = text.find(',', begin);
+			std::string element(text, begin, end == std::string::npos ? std::string::npos : end - begin);
+
+			unsigned long first, last;
+
+			if (element.empty())
+				return false;
+
+			if (numberRange(element, first, last))
+			{
+				// numbers from the first to the last, in either direction
+				for (unsigned long number = first; elements.size() <= limit; number = first < last ? number + 1 : number - 1)
+				{
+					elements.push_back(boost::lexical_cast<std::string>(number));
+
+					if (number == last)
+						break;
+				}
+
+				list = true;
+			}
+			else
+				elements.push_back(element);
+
+			if (end == std::string::npos || elements.size() > limit)
+				break;
+
+			list = true;
+			begin = end + 1;
+		}
+
+		return list;
+	}
+
+	/*
+	 * Words the token stands for, lists following 'from'
+	 * are expanded. False if there would be more than 'limit'.
+	 */
+	bool expandWord(const std::string& word, size_t from, size_t limit, BasicStringContainer_t& words)
+	{
+		size_t open = word.find('{', from);
+		size_t close = open == std::string::npos ? std::string::npos : word.find('}', open);
+
+		if (close == std::string::npos)
+		{
+			words.push_back(word);
+			return words.size() <= limit;
+		}
+
+		BasicStringContainer_t elements;
+
+		if (!listElements(word.substr(open + 1, close - open - 1), limit, elements))
+			return expandWord(word, close + 1, limit, words);
+
+		if (elements.size() > limit)
+			return false;
+
+		for (BasicStringContainer_t::const_iterator It = elements.begin(); It != elements.end(); ++It)
+		{
+			std::string expanded = word.substr(0, open) + *It + word.substr(close + 1);
+
+			if (!expandWord(expanded, open + It->size(), limit, words))
+				return false;
+		}
+
+		return true;
+	}
+
+} // namespace
+
+Tokenizer::Tokenizer() :
+	pipe_(0)
+{
+	tokens_.reserve(TOKENS_RESERVED);
+}
+
+const TokenViewContainer_t& Tokenizer::split(const char* line, size_t length)
+{
+	const char* It = line;
+	const char* end = line + length;
+	bool wide = length >= SIMD_THRESHOLD;
+
+	tokens_.clear();
+	ranges_.clear();
+	pipe_ = std::string::npos;
+
+	for (;;)
+	{
+		It = skipSpace(It, end, wide);
+
+		if (It == end)
+			break;
+
+		if (*It == '"')
+		{
+			++It;
+			const char* endIt = static_cast<const char*>(memchr(It, '"', end - It));
+
+			if (endIt != NULL)
+			{
+				const char* first = skipSpace(It, endIt, false);
+				const char* last = endIt;
+
+				while (last != first && isSpace(*(last - 1)))
+					--last;
+
+				tokens_.push_back(TokenView_t(first, last - first));
+
+				// the character after the closing quote separates tokens
+				It = endIt + 1;
+				if (It != end)
+					++It;
+			}
+			else
+			{
+				// here we willn't trim
+				tokens_.push_back(TokenView_t(It, end - It));
+				It = end;
+			}
+		}
+		else
+		{
+			const char* endIt = findSpace(It, end, wide);
+
+			if (pipe_ == std::string::npos && endIt - It == 1 && *It == '|')
+				pipe_ = tokens_.size();
+
+			if (pipe_ == std::string::npos && memchr(It, '{', endIt - It) != NULL)
+				ranges_.push_back(tokens_.size());
+
+			tokens_.push_back(TokenView_t(It, endIt - It));
+			It = endIt;
+		}
+	}
+
+	if (pipe_ == std::string::npos)
+		pipe_ = tokens_.size();
+
+	return tokens_;
+}
+
+void Tokenizer::assign(BasicStringContainer_t& array) const
+{
+	assign(tokens_.begin(), tokens_.end(), array);
+}
+
+void Tokenizer::assign(BasicStringContainer_t& array, BasicStringContainer_t& filter) const
+{
+	assign(tokens_.begin(), tokens_.begin() + pipe_, array);
+	assign(tokens_.begin() + pipe_, tokens_.end(), filter);
+}
+
+bool Tokenizer::expand(const BasicStringContainer_t& tokens, size_t limit,
+		std::vector<BasicStringContainer_t>& lines) const
+{
+	lines.assign(1, tokens);
+
+	BasicStringContainer_t words;
+
+	for (std::vector<size_t>::const_iterator It = ranges_.begin(); It != ranges_.end(); ++It)
+	{
+		if (*It >= tokens.size())
+			break;
+
+		words.clear();
+
+		if (!expandWord(tokens[*It], 0, limit, words))
+			return false;
+
+		// a list of one element still stands for that element
+		if (words.size() == 1)
+		{
+			for (std::vector<BasicStringContainer_t>::iterator lineIt = lines.begin(); lineIt != lines.end(); ++lineIt)
+				(*lineIt)[*It] = words[0];
+
+			continue;
+		}
+
+		if (words.size() * lines.size() > limit)
+			return false;
+
+		// every line so far is combined with every word, the earlier list varies slowest
+		std::vector<BasicStringContainer_t> combined;
+		combined.reserve(lines.size() * words.size());
+
+		for (std::vector<BasicStringContainer_t>::const_iterator lineIt = lines.begin(); lineIt != lines.end(); ++lineIt)
+		{
+			for (BasicStringContainer_t::const_iterator wordIt = words.begin(); wordIt != words.end(); ++wordIt)
+			{
+				combined.push_back(*lineIt);
+				combined.back()[*It] = *wordIt;
+			}
+		}
+
+		lines.swap(combined);
+	}
+
+	return true;
+}
+
+void Tokenizer::assign(TokenViewContainer_t::const_iterator first,
+		TokenViewContainer_t::const_iterator last, BasicStringContainer_t& array)
+{
+	array.resize(last - first);
+
+	for (size_t i = 0; first != last; ++first, ++i)
+		array[i].assign(first->data(), first->size());
+}
+
+} // CLI
@@ -0,0 +1,86 @@
+/*
+ * cliTokenizer.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLITOKENIZER_H_
+#define CLITOKENIZER_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "cliApi.h"
+
+namespace CLI {
+
+	typedef boost::string_ref             TokenView_t;
+	typedef std::vector<TokenView_t>      TokenViewContainer_t;
+
+	/*
+	 * Splits a command line into tokens without copying it.
+	 *
+	 * Tokens are separated by white spaces. A token starting with '"' lasts
+	 * up to the closing quote and is trimmed, the character following the
+	 * closing quote is a separator. An unterminated quote takes the rest of
+	 * the line as is. The first '|' token which is not quoted starts the
+	 * output filters of the line.
+	 *
+	 * A command token which is not quoted may hold lists like "{1-48}",
+	 * "{1,3,5-7}" or "{in,out}", the line then stands for one command per
+	 * element, see expand(). Braces holding no list are taken as they are.
+	 *
+	 * Returned views point into the line passed to split() and are valid
+	 * until the line is changed or split() is called again. The container
+	 * is kept between calls, so splitting does not allocate once it has
+	 * grown to the longest line seen.
+	 */
+	class Tokenizer
+	{
+		public:
+			Tokenizer();
+
+			const TokenViewContainer_t& split(const char* line, size_t length);
+			const TokenViewContainer_t& split(const std::string& line)
+			{
+				return split(line.data(), line.size());
+			}
+
+			const TokenViewContainer_t& tokens() const { return tokens_; }
+
+			/* Index of the token starting the output filters, tokens().size() if none */
+			size_t pipe() const { return pipe_; }
+
+			/* Some command token may hold a list */
+			bool ranged() const { return !ranges_.empty(); }
+
+			/*
+			 * Commands the tokens assigned from the last split stand for, one
+			 * per combination of the elements of their lists, in the order
+			 * the lists are written. Fails if there would be more than
+			 * 'limit' of them.
+			 */
+			bool expand(const BasicStringContainer_t& tokens, size_t limit,
+					std::vector<BasicStringContainer_t>& lines) const;
+
+			/* Copies the tokens reusing the strings already held by array */
+			void assign(BasicStringContainer_t& array) const;
+
+			/* Same, the pipe and the tokens following it go to filter */
+			void assign(BasicStringContainer_t& array, BasicStringContainer_t& filter) const;
+
+		private:
+			static void assign(TokenViewContainer_t::const_iterator first,
+					TokenViewContainer_t::const_iterator last, BasicStringContainer_t& array);
+
+			TokenViewContainer_t tokens_;
+			size_t               pipe_;
+			std::vector<size_t>  ranges_;   // command tokens with '{', not quoted
+	};
+
+} // CLI
+
+#endif /* CLITOKENIZER_H_ */
@@ -0,0 +1,220 @@
+/*
+ * cliTransaction.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <boost/thread/mutex.hpp>
+
+#include "cliJobs.h"
+#include "cliResultCache.h"
+#include "cliSession.h"
+#include "cliTransaction.h"
+
+namespace CLI {
+
+namespace {
+
+	typedef std::map<std::string, ConfigBackend_t> ConfigBackendStorageType_t;
+
+	ConfigBackendStorageType_t backends;
+	boost::mutex backendSync;
+
+	bool findBackend(const std::string& name, ConfigBackend_t& backend)
+	{
+		boost::mutex::scoped_lock lock(backendSync);
+
+		ConfigBackendStorageType_t::const_iterator It = backends.find(name);
+
+		if (It == backends.end())
+			return false;
+
+		backend = It->second;
+		return true;
+	}
+
+	bool applyChanges(const std::string& name, const ConfigChangeContainer_t& changes, std::string& error)
+	{
+		ConfigBackend_t backend;
+
+		if (!findBackend(name, backend))
+		{
+			error = "no backend";
+			return false;
+		}
+
+		return backend(changes, error);
+	}
+
+} // namespace
+
+void registerConfigBackend(const std::string& name, const ConfigBackend_t& backend)
+{
+	boost::mutex::scoped_lock lock(backendSync);
+
+	backends[name] = backend;
+}
+
+bool applyConfig(const std::string& backend, const std::string& key, const std::string& value)
+{
+	// jobs never run inside a batch, the engine runs its lines in the foreground
+	ConfigTransaction* transaction = JobManager::current() ? NULL : &currentSession().transaction;
+
+	if (transaction && transaction->open())
+	{
+		transaction->stage(backend, key, value);
+		return true;
+	}
+
+	ConfigChangeContainer_t changes(1);
+	changes[0].key = key;
+	changes[0].value = value;
+
+	std::string error;
+
+	if (!applyChanges(backend, changes, error))
+	{
+		commandOutput() << TR("Configuration failed") << ": " << backend << ": " << error << '\n';
+		return false;
+	}
+
+	return true;
+}
+
+void ConfigTransaction::begin()
+{
+	batches_.clear();
+	staged_ = 0;
+	open_ = true;
+}
+
+void ConfigTransaction::stage(const std::string& backend, const std::string& key, const std::string& value)
+{
+	std::vector<Batch>::iterator It = batches_.begin();
+	while (It != batches_.end() && It->backend != backend)
+		++It;
+
+	if (It == batches_.end())
+	{
+		batches_.push_back(Batch());
+		It = batches_.end() - 1;
+		It->backend = backend;
+	}
+
+	++staged_;
+
+	if (tags_)
+		It->tags.insert(tags_->begin(), tags_->end());
+
+	std::map<std::string, size_t>::const_iterator keyIt = It->index.find(key);
+
+	if (keyIt != It->index.end())
+	{
+		It->changes[keyIt->second].value = value;
+		return;
+	}
+
+	It->index[key] = It->changes.size();
+
+	It->changes.push_back(ConfigChange());
+	It->changes.back().key = key;
+	It->changes.back().value = value;
+}
+
+size_t ConfigTransaction::size() const
+{
+	size_t count = 0;
+
+	for (std::vector<Batch>::const_iterator It = batches_.begin(); It != batches_.end(); ++It)
+		count += It->changes.size();
+
+	return count;
+}
+
+bool ConfigTransaction::commit(std::string& error)
+{
+	std::vector<Batch>::iterator It = batches_.begin();
+
+	for (; It != batches_.end(); ++It)
+	{
+		if (!applyChanges(It->backend, It->changes, error))
+		{
+			error = It->backend + ": " + error;
+
+			// what was applied is no longer part of the batch
+			batches_.erase(batches_.begin(), It);
+			return false;
+		}
+
+		for (std::set<std::string>::const_iterator tagIt = It->tags.begin(); tagIt != It->tags.end(); ++tagIt)
+			invalidateResults(*tagIt);
+	}
+
+	abort();
+
+	return true;
+}
+
+void ConfigTransaction::abort()
+{
+	batches_.clear();
+	open_ = false;
+}
+
+bool commitsTransaction(const ConfigTransaction& transaction, const BasicStringContainer_t& tokens)
+{
+	return transaction.open() && tokens.size() == 1 && tokens[0] == "commit";
+}
+
+bool transactionCommand(ConfigTransaction& transaction, const BasicStringContainer_t& tokens, bool* failed)
+{
+	std::ostream& out = commandOutput();
+	bool done = true;
+
+	if (tokens.size() == 2 && tokens[0] == "configure" && tokens[1] == "batch")
+	{
+		if (transaction.open())
+		{
+			out << TR("A configuration batch is open already") << '\n';
+			done = false;
+		}
+		else
+		{
+			transaction.begin();
+			out << TR("Changes are staged until 'commit', 'abort' drops them") << '\n';
+		}
+	}
+	else if (!transaction.open() || tokens.size() != 1 || (tokens[0] != "commit" && tokens[0] != "abort"))
+		return false;
+	else if (tokens[0] == "abort")
+	{
+		size_t count = transaction.size();
+
+		transaction.abort();
+		out << count << " " << TR("changes dropped") << '\n';
+	}
+	else
+	{
+		size_t count = transaction.size();
+		std::string error;
+
+		done = transaction.commit(error);
+
+		if (done)
+			out << count << " " << TR("changes committed") << '\n';
+		else
+		{
+			out << TR("Commit failed") << ": " << error << '\n';
+			out << count - transaction.size() << " " << TR("changes applied") << ", " << transaction.size() << " "
+					<< TR("still staged: 'commit' retries them, 'abort' drops them") << '\n';
+		}
+	}
+
+	if (failed)
+		*failed = !done;
+
+	return true;
+}
+
+} // CLI
@@ -0,0 +1,120 @@
+/*
+ * cliTransaction.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLITRANSACTION_H_
+#define CLITRANSACTION_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "cliApi.h"
+
+namespace CLI {
+
+	/* Setting of a backend a command changes */
+	struct ConfigChange
+	{
+		std::string key;
+		std::string value;
+	};
+
+	typedef std::vector<ConfigChange> ConfigChangeContainer_t;
+
+	/*
+	 * Applies the changes to the backend in one operation. Returns false
+	 * with the reason if it failed.
+	 */
+	typedef boost::function<bool (const ConfigChangeContainer_t&, std::string&)> ConfigBackend_t;
+
+	/* Has to be called before commands change the backend */
+	void registerConfigBackend(const std::string& name, const ConfigBackend_t& backend);
+
+	/*
+	 * For commands changing the configuration, called from execute().
+	 * Outside a configuration batch the change is applied at once and a
+	 * failure is reported to commandOutput(). Inside one it is staged
+	 * until 'commit'. Returns false if the change was rejected.
+	 */
+	bool applyConfig(const std::string& backend, const std::string& key, const std::string& value);
+
+	/*
+	 * Changes staged between 'configure batch' and 'commit' or 'abort'.
+	 *
+	 * A key changed several times is applied once with its last value.
+	 * On commit each backend gets all its changes in a single call, the
+	 * backends in the order they were first changed in; abort forgets
+	 * the changes without calling any. If a backend fails, the backends
+	 * before it stay applied and the batch stays open with the changes
+	 * of the failed backend and those after it, to be committed again
+	 * or aborted.
+	 *
+	 * The result cache tags of the commands which staged the changes of
+	 * a backend are invalidated once that backend applied them.
+	 */
+	class ConfigTransaction
+	{
+		public:
+			ConfigTransaction() : tags_(NULL), staged_(0), open_(false) {}
+
+			bool open() const { return open_; }
+
+			void begin();
+			void stage(const std::string& backend, const std::string& key, const std::string& value);
+
+			/* Tags invalidated on commit by the changes staged from now on, NULL for none */
+			void tagChanges(const BasicStringContainer_t* tags) { tags_ = tags; }
+
+			/* Calls of stage() since begin(), tells whether a command staged anything */
+			size_t staged() const { return staged_; }
+
+			/* Changes to apply, after coalescing */
+			size_t size() const;
+
+			/*
+			 * Applies and ends the batch. False with the backend and the
+			 * reason if a backend failed, the batch is still open then.
+			 */
+			bool commit(std::string& error);
+			void abort();
+
+		private:
+			struct Batch
+			{
+				std::string                    backend;
+				ConfigChangeContainer_t        changes;
+				std::map<std::string, size_t>  index;   // position of a key in changes
+				std::set<std::string>          tags;    // invalidated once applied
+			};
+
+			std::vector<Batch>            batches_;
+			const BasicStringContainer_t* tags_;
+			size_t                        staged_;
+			bool                          open_;
+	};
+
+	/*
+	 * Internal 'configure batch', and 'commit' and 'abort' while the batch
+	 * is open; outside a batch the latter are left to registered commands.
+	 * Returns false if tokens are not a transaction command. 'failed' is
+	 * set if the command did not do what it was asked to.
+	 */
+	bool transactionCommand(ConfigTransaction& transaction, const BasicStringContainer_t& tokens,
+			bool* failed = NULL);
+
+	/*
+	 * Whether tokens are the 'commit' of the open batch. Applying it writes
+	 * the configuration, the engine runs it alone as an exclusive command.
+	 */
+	bool commitsTransaction(const ConfigTransaction& transaction, const BasicStringContainer_t& tokens);
+
+} // CLI
+
+#endif /* CLITRANSACTION_H_ */
@@ -0,0 +1,287 @@
+/*
+ * cliCommandIndexTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <gtest/gtest.h>
+
+#include "cliCommandIndex.h"
+#include "cliPrefixTrie.h"
+#include "cliTestCommand.h"
+
+using namespace CLI;
+
+namespace {
+
+	class CommandIndexTest : public ::testing::Test
+	{
+		protected:
+			void SetUp()
+			{
+				add("show interface");
+				add("show ip route");
+				add("show ipv6 route");
+				add("shutdown");
+				add("clear counters");
+			}
+
+			void add(const std::string& line)
+			{
+				index_.insert(CommandPtr_t(new KeywordCommand(line)));
+			}
+
+			void match(const std::string& line)
+			{
+				tokens_ = words(line);
+				index_.match(tokens_, tokens_.size(), match_);
+			}
+
+			CommandIndex::CompletionContainer_t ambiguity()
+			{
+				CommandIndex::CompletionContainer_t keywords;
+				index_.ambiguity(tokens_, match_, keywords);
+				return keywords;
+			}
+
+			CommandIndex           index_;
+			BasicStringContainer_t tokens_;
+			CommandIndex::Match    match_;
+	};
+
+	bool denyAll(const std::string& )
+	{
+		return false;
+	}
+
+	typedef PrefixTrie<int> Trie_t;
+
+	/* Keywords in the order visit() reports them */
+	struct Collect
+	{
+		Collect(const Trie_t& trie) : trie_(trie) {}
+
+		void operator()(Trie_t::Index_t index) { words.push_back(trie_.word(index)); }
+
+		const Trie_t&          trie_;
+		BasicStringContainer_t words;
+	};
+
+} // namespace
+
+TEST(PrefixTrie, UniqueAbbreviation)
+{
+	Trie_t trie;
+	trie.set("show", 1);
+	trie.set("shutdown", 2);
+	trie.set("clear", 3);
+
+	Trie_t::Index_t vertex = trie.find("cl");
+
+	ASSERT_NE(Trie_t::NONE, vertex);
+	EXPECT_EQ(1u, trie.count(vertex));
+	EXPECT_EQ(Trie_t::NONE, trie.exact(vertex));
+	ASSERT_NE(Trie_t::NONE, trie.unique(vertex));
+	EXPECT_EQ("clear", trie.word(trie.unique(vertex)));
+	EXPECT_EQ(3, trie.value(trie.unique(vertex)));
+}
+
+TEST(PrefixTrie, AmbiguousAbbreviation)
+{
+	Trie_t trie;
+	trie.set("show", 1);
+	trie.set("shutdown", 2);
+
+	Trie_t::Index_t vertex = trie.find("sh");
+
+	ASSERT_NE(Trie_t::NONE, vertex);
+	EXPECT_EQ(2u, trie.count(vertex));
+	EXPECT_EQ(Trie_t::NONE, trie.unique(vertex));
+
+	Collect collect(trie);
+	trie.visit(vertex, collect);
+
+	ASSERT_EQ(2u, collect.words.size());
+	EXPECT_EQ("show", collect.words[0]);
+	EXPECT_EQ("shutdown", collect.words[1]);
+}
+
+TEST(PrefixTrie, KeywordPrefixOfAnother)
+{
+	Trie_t trie;
+	trie.set("ipv6", 1);
+	trie.set("ip", 2);
+
+	Trie_t::Index_t vertex = trie.find("ip");
+
+	EXPECT_EQ(2u, trie.count(vertex));
+	ASSERT_NE(Trie_t::NONE, trie.exact(vertex));
+	EXPECT_EQ("ip", trie.word(trie.unique(vertex)));
+}
+
+TEST(PrefixTrie, UnknownToken)
+{
+	Trie_t trie;
+	trie.set("show", 1);
+
+	EXPECT_EQ(Trie_t::NONE, trie.find("x"));
+	EXPECT_EQ(Trie_t::NONE, trie.find("showx"));
+}
+
+TEST(PrefixTrie, SetAgainChangesValue)
+{
+	Trie_t trie;
+	trie.set("show", 1);
+	trie.set("show", 5);
+
+	Trie_t::Index_t vertex = trie.find("show");
+
+	EXPECT_EQ(1u, trie.count(vertex));
+	EXPECT_EQ(5, trie.value(trie.exact(vertex)));
+}
+
+TEST(PrefixTrie, VisitsInCharacterOrder)
+{
+	Trie_t trie;
+	trie.set("b", 1);
+	trie.set("\xe4", 2);
+	trie.set("a", 3);
+	trie.set("ab", 4);
+
+	Collect collect(trie);
+	trie.visit(trie.find(""), collect);
+
+	ASSERT_EQ(4u, collect.words.size());
+	EXPECT_EQ("a", collect.words[0]);
+	EXPECT_EQ("ab", collect.words[1]);
+	EXPECT_EQ("b", collect.words[2]);
+	EXPECT_EQ("\xe4", collect.words[3]);
+}
+
+TEST_F(CommandIndexTest, AbbreviationsSelectTheirKeywords)
+{
+	match("cl co");
+
+	EXPECT_EQ(2u, match_.depth());
+	EXPECT_EQ(match_.depth(), match_.ambiguous());
+	ASSERT_TRUE(match_.keyword(0) != NULL);
+	EXPECT_EQ("clear", *match_.keyword(0));
+	EXPECT_EQ("counters", *match_.keyword(1));
+	EXPECT_EQ(1u, match_.commands().size());
+}
+
+TEST_F(CommandIndexTest, NextTokenNarrowsAnAmbiguousOne)
+{
+	match("sh int");
+
+	EXPECT_EQ(2u, match_.depth());
+	EXPECT_EQ(0u, match_.ambiguous());
+	EXPECT_TRUE(match_.keyword(0) == NULL);
+	EXPECT_EQ("interface", *match_.keyword(1));
+
+	// 'shutdown' would take "int" as a parameter
+	ASSERT_EQ(2u, match_.commands().size());
+	EXPECT_EQ(2u, match_.depth(0));
+	EXPECT_EQ(1u, match_.depth(1));
+}
+
+TEST_F(CommandIndexTest, AmbiguousAbbreviation)
+{
+	match("sh");
+
+	EXPECT_EQ(1u, match_.depth());
+	EXPECT_EQ(0u, match_.ambiguous());
+	EXPECT_TRUE(match_.keyword(0) == NULL);
+
+	CommandIndex::CompletionContainer_t keywords = ambiguity();
+
+	ASSERT_EQ(2u, keywords.size());
+	EXPECT_EQ("show", keywords[0]);
+	EXPECT_EQ("shutdown", keywords[1]);
+}
+
+TEST_F(CommandIndexTest, ExactKeywordIsNotAmbiguous)
+{
+	match("show ip route");
+
+	EXPECT_EQ(3u, match_.depth());
+	EXPECT_EQ(3u, match_.ambiguous());
+	EXPECT_EQ("ip", *match_.keyword(1));
+	EXPECT_EQ(1u, match_.commands().size());
+	EXPECT_TRUE(ambiguity().empty());
+}
+
+TEST_F(CommandIndexTest, AmbiguityAfterUniqueKeywords)
+{
+	match("show i");
+
+	EXPECT_EQ(2u, match_.depth());
+	EXPECT_EQ(1u, match_.ambiguous());
+
+	CommandIndex::CompletionContainer_t keywords = ambiguity();
+
+	ASSERT_EQ(3u, keywords.size());
+	EXPECT_EQ("interface", keywords[0]);
+	EXPECT_EQ("ip", keywords[1]);
+	EXPECT_EQ("ipv6", keywords[2]);
+}
+
+TEST_F(CommandIndexTest, EmptyTokenIsNoKeyword)
+{
+	match("\"\"");
+
+	EXPECT_EQ(0u, match_.depth());
+	EXPECT_EQ(0u, match_.ambiguous());
+	EXPECT_TRUE(match_.commands().empty());
+	EXPECT_TRUE(ambiguity().empty());
+
+	match("show \"\"");
+
+	EXPECT_EQ(1u, match_.depth());
+	EXPECT_EQ(1u, match_.ambiguous());
+	EXPECT_TRUE(ambiguity().empty());
+}
+
+TEST_F(CommandIndexTest, UnknownTokenStopsTheMatch)
+{
+	match("show vlan");
+
+	EXPECT_EQ(1u, match_.depth());
+	EXPECT_TRUE(match_.commands().empty());
+
+	match("show interface eth0");
+
+	// parameters follow the keyword path
+	EXPECT_EQ(2u, match_.depth());
+	ASSERT_EQ(1u, match_.commands().size());
+	EXPECT_EQ(2u, match_.depth(0));
+}
+
+TEST_F(CommandIndexTest, ExhaustedWhileThePathGoesOn)
+{
+	match("show ip");
+
+	EXPECT_TRUE(match_.exhausted());
+	EXPECT_TRUE(match_.commands().empty());
+
+	match("shutdown");
+
+	EXPECT_FALSE(match_.exhausted());
+	EXPECT_EQ(1u, match_.commands().size());
+}
+
+TEST_F(CommandIndexTest, CommandsOfNoGroupAreNotSeen)
+{
+	// no group was let in by the hook yet
+	index_.insert(CommandInfoPtr_t(new CommandInfo(CommandPtr_t(new KeywordCommand("shell")),
+			CLI_ACCESS_EXCLUSIVE, denyAll)));
+
+	match("shel");
+
+	EXPECT_EQ(0u, match_.depth());
+
+	match("sh");
+
+	EXPECT_EQ(2u, ambiguity().size());
+}
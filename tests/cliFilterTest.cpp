@@ -0,0 +1,182 @@
+/*
+ * cliFilterTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "cliFilter.h"
+#include "cliTestCommand.h"
+
+using namespace CLI;
+
+namespace {
+
+	const char OUTPUT[] =
+		"interface eth0\n"
+		" description uplink\n"
+		"interface eth1\n"
+		" shutdown\n"
+		"vlan 10\n"
+		" name users\n";
+
+	/* What the filter typed after the command leaves of the output */
+	std::string filtered(const std::string& filters, const std::string& output = OUTPUT)
+	{
+		OutputFilter filter;
+		CommandError_t cmdError;
+		BasicStringContainer_t tokens = words(filters);
+
+		EXPECT_TRUE(filter.parse(tokens, cmdError)) << filters;
+
+		std::stringbuf result;
+		std::ostream out(&result);
+		{
+			OutputFilter::Scope scope(out, filter);
+			out << output;
+		}
+
+		return result.str();
+	}
+
+	/* Position of the token parse() refused, -1 if it took the filters */
+	int refused(const std::string& filters, CommandErrorCode_t& error)
+	{
+		OutputFilter filter;
+		CommandError_t cmdError;
+		BasicStringContainer_t tokens = words(filters);
+
+		if (filter.parse(tokens, cmdError))
+			return -1;
+
+		error = cmdError.error;
+		return cmdError.position - tokens.begin();
+	}
+
+} // namespace
+
+TEST(OutputFilter, Include)
+{
+	EXPECT_EQ("interface eth0\ninterface eth1\n", filtered("| include ^interface"));
+	EXPECT_EQ("interface eth1\n", filtered("| i eth1"));
+	EXPECT_EQ("", filtered("| include ospf"));
+}
+
+TEST(OutputFilter, ExpressionIsTheRestOfTheStage)
+{
+	EXPECT_EQ(" name users\n", filtered("| include name users"));
+}
+
+TEST(OutputFilter, Exclude)
+{
+	EXPECT_EQ("interface eth0\ninterface eth1\nvlan 10\n", filtered("| exclude ^\\s"));
+}
+
+TEST(OutputFilter, Begin)
+{
+	EXPECT_EQ("interface eth1\n shutdown\nvlan 10\n name users\n", filtered("| begin eth1"));
+	EXPECT_EQ("", filtered("| begin ospf"));
+}
+
+TEST(OutputFilter, Count)
+{
+	EXPECT_EQ("Number of lines: 6\n", filtered("| count"));
+	EXPECT_EQ("Number of lines: 2\n", filtered("| count interface"));
+	EXPECT_EQ("Number of lines: 0\n", filtered("| count", ""));
+}
+
+TEST(OutputFilter, Chain)
+{
+	EXPECT_EQ(" shutdown\nvlan 10\n", filtered("| begin eth1 | exclude name | exclude ^interface"));
+	EXPECT_EQ("Number of lines: 3\n", filtered("| begin eth1 | exclude ^interface | count"));
+}
+
+TEST(OutputFilter, LastLineWithoutNewline)
+{
+	EXPECT_EQ("vlan 10\nvlan 20", filtered("| include vlan", "vlan 10\nname users\nvlan 20"));
+	EXPECT_EQ("Number of lines: 2\n", filtered("| count vlan", "vlan 10\nvlan 20"));
+}
+
+TEST(OutputFilter, LinesLongerThanTheBuffer)
+{
+	std::string line(3 * OutputFilter::BUFFER_SIZE, 'x');
+
+	EXPECT_EQ(line + "y\n", filtered("| include y$", "x\n" + line + "y\nz\n"));
+	EXPECT_EQ("Number of lines: 3\n", filtered("| count", "x\n" + line + "y\nz\n"));
+}
+
+TEST(OutputFilter, DismissedScopeWritesNothing)
+{
+	OutputFilter filter;
+	CommandError_t cmdError;
+
+	ASSERT_TRUE(filter.parse(words("| count"), cmdError));
+
+	std::stringbuf result;
+	std::ostream out(&result);
+	{
+		OutputFilter::Scope scope(out, filter);
+		scope.dismiss();
+		out << "after";
+	}
+
+	EXPECT_EQ("after", result.str());
+}
+
+TEST(OutputFilter, ParseErrors)
+{
+	CommandErrorCode_t error = CLI_CMD_OK;
+
+	EXPECT_EQ(1, refused("|", error));
+	EXPECT_EQ(CLI_CMD_SHORT, error);
+
+	EXPECT_EQ(2, refused("| include", error));
+	EXPECT_EQ(CLI_CMD_SHORT, error);
+
+	EXPECT_EQ(4, refused("| include x |", error));
+	EXPECT_EQ(CLI_CMD_SHORT, error);
+
+	EXPECT_EQ(1, refused("| grep x", error));
+	EXPECT_EQ(CLI_CMD_WRONG_KEYWORD, error);
+
+	EXPECT_EQ(2, refused("| include (x", error));
+	EXPECT_EQ(CLI_CMD_WRONG_VALUE, error);
+
+	EXPECT_EQ(2, refused("| count | include x", error));
+	EXPECT_EQ(CLI_CMD_TOO_LONG, error);
+
+	EXPECT_EQ(-1, refused("| count x", error));
+}
+
+TEST(OutputFilter, ExpressionTooComplexForALine)
+{
+	std::string output = "short y\n" + std::string(40, 'x') + "\nlast";
+
+	// the notice starts on a line of its own
+	EXPECT_EQ(output + "\nExpression too complex, lines taken as not matching: 1\n",
+			filtered("| exclude (x+x+)+y", output));
+	EXPECT_EQ("Expression too complex, lines taken as not matching: 1\n",
+			filtered("| include (x+x+)+y", output));
+}
+
+TEST(OutputFilter, Help)
+{
+	BasicStringContainer_t lines;
+
+	OutputFilter::help(words("|"), lines);
+	EXPECT_EQ(4u, lines.size());
+
+	OutputFilter::help(words("| inc"), lines);
+	ASSERT_EQ(1u, lines.size());
+
+	OutputFilter::help(words("| include x"), lines);
+	ASSERT_EQ(2u, lines.size());
+	EXPECT_EQ("<cr>", lines[1]);
+
+	OutputFilter::help(words("| grep"), lines);
+	EXPECT_TRUE(lines.empty());
+}
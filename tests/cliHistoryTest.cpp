@@ -0,0 +1,305 @@
+/*
+ * cliHistoryTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include <boost/thread/thread.hpp>
+
+#include <gtest/gtest.h>
+
+#include "cliHistory.h"
+
+using namespace CLI;
+
+namespace {
+
+	const size_t TEXT_SIZE = HistoryFile::SLOT_SIZE - 16;
+	const size_t CAPACITY  = 8;
+
+	class HistoryFileTest : public ::testing::Test
+	{
+		protected:
+			void SetUp()
+			{
+				char directory[] = "/tmp/cliHistoryTest.XXXXXX";
+
+				ASSERT_TRUE(::mkdtemp(directory) != NULL);
+				directory_ = directory;
+				path_ = directory_ + "/history";
+			}
+
+			void TearDown()
+			{
+				std::string command = "rm -rf " + directory_;
+				EXPECT_EQ(0, ::system(command.c_str()));
+			}
+
+			BasicStringContainer_t recent(HistoryFile& history, size_t count = CAPACITY)
+			{
+				BasicStringContainer_t lines;
+				history.recent(count, lines);
+				return lines;
+			}
+
+			std::string directory_;
+			std::string path_;
+	};
+
+	std::string numbered(const char* prefix, size_t number)
+	{
+		std::ostringstream line;
+		line << prefix << number;
+		return line.str();
+	}
+
+	/* Lines of the writer below: the number, then a filler of its last digit */
+	std::string stamped(size_t number)
+	{
+		std::string line = numbered("", number);
+		return line + ' ' + std::string(number % 200, line[line.size() - 1]);
+	}
+
+	bool wellFormed(const std::string& line)
+	{
+		size_t number = strtoul(line.c_str(), NULL, 10);
+		return line == stamped(number);
+	}
+
+	void appendStamped(HistoryFile* history, size_t count)
+	{
+		for (size_t i = 1; i <= count; ++i)
+			history->append(stamped(i));
+	}
+
+} // namespace
+
+TEST_F(HistoryFileTest, RecentOldestFirst)
+{
+	HistoryFile history;
+	ASSERT_TRUE(history.open(path_, CAPACITY));
+
+	history.append("show interface");
+	history.append("");
+	history.append("show vlan");
+	history.append("clear counters");
+
+	BasicStringContainer_t lines = recent(history);
+
+	ASSERT_EQ(3u, lines.size());
+	EXPECT_EQ("show interface", lines[0]);
+	EXPECT_EQ("clear counters", lines[2]);
+
+	// appended to, not replaced
+	history.recent(1, lines);
+
+	ASSERT_EQ(4u, lines.size());
+	EXPECT_EQ("clear counters", lines[3]);
+}
+
+TEST_F(HistoryFileTest, LineEnteredAgainMovesToTheTop)
+{
+	HistoryFile history;
+	ASSERT_TRUE(history.open(path_, CAPACITY));
+
+	history.append("a1");
+	history.append("b2");
+	history.append("a1");
+	history.append("a1");
+
+	BasicStringContainer_t lines = recent(history);
+
+	ASSERT_EQ(2u, lines.size());
+	EXPECT_EQ("b2", lines[0]);
+	EXPECT_EQ("a1", lines[1]);
+}
+
+TEST_F(HistoryFileTest, OverLengthLineIsNotKept)
+{
+	HistoryFile history;
+	ASSERT_TRUE(history.open(path_, CAPACITY));
+
+	std::string longest(TEXT_SIZE, 'x');
+
+	history.append(longest + "y");
+	history.append(longest);
+
+	BasicStringContainer_t lines = recent(history);
+
+	ASSERT_EQ(1u, lines.size());
+	EXPECT_EQ(longest, lines[0]);
+}
+
+TEST_F(HistoryFileTest, RingWrapsAround)
+{
+	HistoryFile history;
+	ASSERT_TRUE(history.open(path_, CAPACITY));
+
+	// often enough for the trigram index to be pruned too
+	for (size_t i = 0; i < 5 * CAPACITY; ++i)
+		history.append(numbered("line ", i));
+
+	BasicStringContainer_t lines = recent(history, 100);
+
+	ASSERT_EQ(CAPACITY, lines.size());
+	EXPECT_EQ(numbered("line ", 4 * CAPACITY), lines[0]);
+	EXPECT_EQ(numbered("line ", 5 * CAPACITY - 1), lines[CAPACITY - 1]);
+
+	std::string line;
+
+	EXPECT_EQ(0u, history.search(numbered("line ", 4 * CAPACITY - 1), ~0ULL, line));
+	EXPECT_EQ(0u, history.search("line 1", ~0ULL, line));
+	EXPECT_NE(0u, history.search(numbered("line ", 4 * CAPACITY), ~0ULL, line));
+	EXPECT_EQ(numbered("line ", 4 * CAPACITY), line);
+
+	// a line gone from the ring is new again
+	history.append("line 0");
+	EXPECT_EQ("line 0", recent(history, 1)[0]);
+}
+
+TEST_F(HistoryFileTest, SearchPagesToOlderLines)
+{
+	HistoryFile history;
+	ASSERT_TRUE(history.open(path_, CAPACITY));
+
+	history.append("show interface eth0");
+	history.append("clear counters");
+	history.append("show interface eth1");
+	history.append("show vlan");
+
+	// the long pattern goes through the trigram index, the short one is scanned
+	const char* patterns[] = { "interface", "in" };
+
+	for (size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i)
+	{
+		std::string line;
+
+		boost::uint64_t found = history.search(patterns[i], ~0ULL, line);
+		ASSERT_NE(0u, found) << patterns[i];
+		EXPECT_EQ("show interface eth1", line);
+
+		found = history.search(patterns[i], found, line);
+		ASSERT_NE(0u, found) << patterns[i];
+		EXPECT_EQ("show interface eth0", line);
+
+		EXPECT_EQ(0u, history.search(patterns[i], found, line)) << patterns[i];
+	}
+
+	std::string line;
+	EXPECT_EQ(0u, history.search("interfaces", ~0ULL, line));
+}
+
+TEST_F(HistoryFileTest, SearchSkipsDeadLines)
+{
+	HistoryFile history;
+	ASSERT_TRUE(history.open(path_, CAPACITY));
+
+	history.append("show vlan");
+	history.append("show interface");
+	history.append("show vlan");
+
+	std::string line;
+	boost::uint64_t found = history.search("vlan", ~0ULL, line);
+
+	ASSERT_NE(0u, found);
+	EXPECT_EQ(0u, history.search("vlan", found, line));
+}
+
+TEST_F(HistoryFileTest, SharedBetweenInstances)
+{
+	HistoryFile first, second;
+	ASSERT_TRUE(first.open(path_, CAPACITY));
+	ASSERT_TRUE(second.open(path_, CAPACITY));
+
+	first.append("show vlan");
+	second.append("show interface");
+	first.append("show vlan");
+
+	BasicStringContainer_t lines = recent(second);
+
+	ASSERT_EQ(2u, lines.size());
+	EXPECT_EQ("show interface", lines[0]);
+	EXPECT_EQ("show vlan", lines[1]);
+
+	std::string line;
+	EXPECT_NE(0u, second.search("vlan", ~0ULL, line));
+	EXPECT_EQ("show vlan", line);
+}
+
+TEST_F(HistoryFileTest, ReaderNeverSeesATornLine)
+{
+	HistoryFile writer, reader;
+	ASSERT_TRUE(writer.open(path_, CAPACITY));
+	ASSERT_TRUE(reader.open(path_, CAPACITY));
+
+	const size_t COUNT = 20000;
+	boost::thread thread(appendStamped, &writer, COUNT);
+
+	size_t torn = 0;
+	size_t seen = 0;
+
+	while (seen < COUNT)
+	{
+		BasicStringContainer_t lines = recent(reader);
+
+		for (BasicStringContainer_t::const_iterator It = lines.begin(); It != lines.end(); ++It)
+		{
+			if (!wellFormed(*It))
+				++torn;
+			else
+				seen = std::max<size_t>(seen, strtoul(It->c_str(), NULL, 10));
+		}
+
+		std::string line;
+		if (reader.search("0 0", ~0ULL, line) != 0 && !wellFormed(line))
+			++torn;
+	}
+
+	thread.join();
+
+	EXPECT_EQ(0u, torn);
+}
+
+TEST_F(HistoryFileTest, OtherLayoutIsMovedAside)
+{
+	{
+		HistoryFile history;
+		ASSERT_TRUE(history.open(path_, CAPACITY));
+		history.append("show vlan");
+	}
+
+	HistoryFile history;
+	ASSERT_TRUE(history.open(path_, 2 * CAPACITY));
+
+	EXPECT_TRUE(recent(history).empty());
+
+	struct stat st;
+	EXPECT_EQ(0, ::stat((path_ + ".old").c_str(), &st));
+	EXPECT_EQ(0, ::stat(path_.c_str(), &st));
+	EXPECT_EQ(0600u, st.st_mode & 0777);
+}
+
+TEST_F(HistoryFileTest, SymbolicLinkIsRefused)
+{
+	std::string target = directory_ + "/target";
+	ASSERT_EQ(0, ::symlink(target.c_str(), path_.c_str()));
+
+	HistoryFile history;
+	EXPECT_FALSE(history.open(path_, CAPACITY));
+	EXPECT_FALSE(history.isOpen());
+
+	// nothing is kept, nothing fails
+	history.append("show vlan");
+	EXPECT_TRUE(recent(history).empty());
+
+	struct stat st;
+	EXPECT_NE(0, ::stat(target.c_str(), &st));
+}
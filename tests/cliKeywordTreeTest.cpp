@@ -0,0 +1,172 @@
+/*
+ * cliKeywordTreeTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "cliCommandIndex.h"
+#include "cliKeywordTree.h"
+#include "cliTestCommand.h"
+
+using namespace CLI;
+
+TEST(KeywordTree, Distance)
+{
+	EXPECT_EQ(0u, KeywordTree::distance("show", "show"));
+	EXPECT_EQ(1u, KeywordTree::distance("show", "shw"));
+	EXPECT_EQ(1u, KeywordTree::distance("show", "shiw"));
+	EXPECT_EQ(2u, KeywordTree::distance("show", "sohw"));
+	EXPECT_EQ(3u, KeywordTree::distance("kitten", "sitting"));
+	EXPECT_EQ(4u, KeywordTree::distance("", "show"));
+}
+
+TEST(KeywordTree, ClosestFirstThenSorted)
+{
+	KeywordTree tree;
+	tree.insert("interface");
+	tree.insert("show");
+	tree.insert("shot");
+	tree.insert("slow");
+	tree.insert("shutdown");
+
+	BasicStringContainer_t found;
+	tree.find("show", 1, found);
+
+	ASSERT_EQ(3u, found.size());
+	EXPECT_EQ("show", found[0]);
+	EXPECT_EQ("shot", found[1]);
+	EXPECT_EQ("slow", found[2]);
+
+	tree.find("interfcae", 1, found);
+	EXPECT_TRUE(found.empty());
+
+	tree.find("interfcae", 2, found);
+	ASSERT_EQ(1u, found.size());
+	EXPECT_EQ("interface", found[0]);
+}
+
+TEST(KeywordTree, DuplicatesAreKeptOnce)
+{
+	KeywordTree tree;
+	tree.insert("show");
+	tree.insert("show");
+
+	EXPECT_EQ(1u, tree.size());
+
+	BasicStringContainer_t found;
+	tree.find("show", 0, found);
+
+	EXPECT_EQ(1u, found.size());
+}
+
+TEST(KeywordTree, FindsWhatAFullScanFinds)
+{
+	// a vocabulary large enough for the pruning to matter
+	BasicStringContainer_t vocabulary;
+
+	for (char first = 'a'; first <= 'z'; first += 3)
+		for (char second = 'a'; second <= 'z'; second += 2)
+			for (size_t length = 2; length < 8; length += 2)
+				vocabulary.push_back(std::string(1, first) + std::string(length, second) + "x");
+
+	KeywordTree tree;
+	for (BasicStringContainer_t::const_iterator It = vocabulary.begin(); It != vocabulary.end(); ++It)
+		tree.insert(*It);
+
+	const char* probes[] = { "dddx", "gx", "mqqqqqx", "zzz", "x" };
+
+	for (size_t i = 0; i < sizeof(probes) / sizeof(probes[0]); ++i)
+	{
+		for (unsigned limit = 0; limit <= 2; ++limit)
+		{
+			BasicStringContainer_t expected, found;
+
+			for (BasicStringContainer_t::const_iterator It = vocabulary.begin(); It != vocabulary.end(); ++It)
+			{
+				if (KeywordTree::distance(probes[i], *It) <= limit)
+					expected.push_back(*It);
+			}
+
+			tree.find(probes[i], limit, found);
+
+			std::sort(expected.begin(), expected.end());
+			std::sort(found.begin(), found.end());
+
+			EXPECT_EQ(expected, found) << probes[i] << " within " << limit;
+		}
+	}
+}
+
+TEST(KeywordTree, Empty)
+{
+	KeywordTree tree;
+	BasicStringContainer_t found(1, "stale");
+
+	tree.find("show", 2, found);
+
+	EXPECT_TRUE(found.empty());
+}
+
+TEST(CommandIndexSuggest, KeywordsCloseToTheStoppingToken)
+{
+	CommandIndex index;
+	index.insert(CommandPtr_t(new KeywordCommand("show interface")));
+	index.insert(CommandPtr_t(new KeywordCommand("show ip route")));
+	index.insert(CommandPtr_t(new KeywordCommand("show vlan")));
+	index.insert(CommandPtr_t(new KeywordCommand("clear counters")));
+
+	BasicStringContainer_t tokens = words("show interfcae");
+	CommandIndex::Match match;
+	index.match(tokens, tokens.size(), match);
+
+	ASSERT_EQ(1u, match.depth());
+
+	CommandIndex::CompletionContainer_t suggestions;
+	index.suggest(match, tokens[1], 5, suggestions);
+
+	ASSERT_EQ(1u, suggestions.size());
+	EXPECT_EQ("interface", suggestions[0]);
+
+	// short tokens get a single edit
+	index.suggest(match, "valn", 5, suggestions);
+	ASSERT_EQ(1u, suggestions.size());
+	EXPECT_EQ("vlan", suggestions[0]);
+
+	index.suggest(match, "ipp", 5, suggestions);
+	ASSERT_EQ(1u, suggestions.size());
+	EXPECT_EQ("ip", suggestions[0]);
+
+	index.suggest(match, "ppp", 5, suggestions);
+	EXPECT_TRUE(suggestions.empty());
+}
+
+TEST(CommandIndexSuggest, LimitAndOneCopyPerKeyword)
+{
+	CommandIndex index;
+	index.insert(CommandPtr_t(new KeywordCommand("show vlan")));
+	index.insert(CommandPtr_t(new KeywordCommand("shutdown vlan")));
+	index.insert(CommandPtr_t(new KeywordCommand("show clan")));
+	index.insert(CommandPtr_t(new KeywordCommand("show plan")));
+
+	// "sh" abbreviates both, so the match stands at two nodes
+	BasicStringContainer_t tokens = words("sh vlam");
+	CommandIndex::Match match;
+	index.match(tokens, tokens.size(), match);
+
+	ASSERT_EQ(1u, match.depth());
+
+	CommandIndex::CompletionContainer_t suggestions;
+	index.suggest(match, tokens[1], 5, suggestions);
+
+	ASSERT_EQ(3u, suggestions.size());
+	EXPECT_EQ(1, std::count(suggestions.begin(), suggestions.end(), "vlan"));
+
+	index.suggest(match, tokens[1], 1, suggestions);
+	ASSERT_EQ(1u, suggestions.size());
+	EXPECT_EQ("vlan", suggestions[0]);
+}
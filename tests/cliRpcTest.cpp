@@ -0,0 +1,178 @@
+/*
+ * cliRpcTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <gtest/gtest.h>
+
+#include "cliRpc.h"
+
+using namespace CLI;
+
+namespace {
+
+	/* The reason a line is refused, empty if it is a request */
+	std::string problem(const std::string& line)
+	{
+		RpcRequest request;
+		std::string reason;
+
+		if (parseRpcRequest(line, request, reason))
+			return std::string();
+
+		EXPECT_FALSE(reason.empty()) << line;
+		return reason;
+	}
+
+	/* The only token of a request holding 'value' */
+	std::string token(const std::string& value)
+	{
+		RpcRequest request;
+		std::string reason;
+
+		EXPECT_TRUE(parseRpcRequest("{\"args\":[" + value + "]}", request, reason)) << value << ": " << reason;
+		EXPECT_EQ(1u, request.args.size()) << value;
+
+		return request.args.empty() ? std::string() : request.args[0];
+	}
+
+} // namespace
+
+TEST(RpcRequest, Args)
+{
+	RpcRequest request;
+	std::string reason;
+
+	ASSERT_TRUE(parseRpcRequest(" { \"id\" : 7 , \"args\" : [ \"show\", \"vlan\", \"10\" ] } ", request, reason));
+
+	EXPECT_EQ("7", request.id);
+	ASSERT_EQ(3u, request.args.size());
+	EXPECT_EQ("vlan", request.args[1]);
+
+	ASSERT_TRUE(parseRpcRequest("{\"args\":[]}", request, reason));
+	EXPECT_EQ("null", request.id);
+	EXPECT_TRUE(request.args.empty());
+}
+
+TEST(RpcRequest, LineIsSplitLikeATypedLine)
+{
+	RpcRequest request;
+	std::string reason;
+
+	ASSERT_TRUE(parseRpcRequest("{\"line\":\"description \\\"to core\\\"  \\tshort\",\"id\":\"a\"}", request, reason));
+
+	EXPECT_EQ("\"a\"", request.id);
+	ASSERT_EQ(3u, request.args.size());
+	EXPECT_EQ("to core", request.args[1]);
+	EXPECT_EQ("short", request.args[2]);
+}
+
+TEST(RpcRequest, IdIsKeptAsItsText)
+{
+	const char* ids[] = { "0", "-12", "1.5", "2e10", "-0.5E-3", "\"x\\u0041\"", "null" };
+
+	for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); ++i)
+	{
+		RpcRequest request;
+		std::string reason;
+
+		ASSERT_TRUE(parseRpcRequest(std::string("{\"id\":") + ids[i] + ",\"args\":[]}", request, reason)) << ids[i];
+		EXPECT_EQ(ids[i], request.id);
+	}
+}
+
+TEST(RpcRequest, OtherKeysAreSkipped)
+{
+	EXPECT_EQ("", problem("{\"meta\":{\"a\":[1,true,false,null,{}]},\"args\":[\"show\"]}"));
+	EXPECT_NE("", problem("{\"meta\":{\"a\":[1,}]},\"args\":[\"show\"]}"));
+
+	// nesting is bounded
+	std::string deep = std::string(40, '[') + std::string(40, ']');
+	EXPECT_NE("", problem("{\"meta\":" + deep + ",\"args\":[]}"));
+}
+
+TEST(RpcRequest, NotARequest)
+{
+	EXPECT_EQ("request is not a JSON object", problem("[\"show\"]"));
+	EXPECT_EQ("request is not a JSON object", problem(""));
+	EXPECT_EQ("no \"args\" or \"line\"", problem("{}"));
+	EXPECT_EQ("no \"args\" or \"line\"", problem("{\"id\":1}"));
+	EXPECT_EQ("malformed object", problem("{\"args\":[] \"id\":1}"));
+	EXPECT_EQ("malformed object", problem("{id:1,\"args\":[]}"));
+	EXPECT_EQ("text after the request", problem("{\"args\":[]} x"));
+	EXPECT_EQ("text after the request", problem("{\"args\":[]}{}"));
+}
+
+TEST(RpcRequest, BadValues)
+{
+	EXPECT_EQ("bad value of \"args\"", problem("{\"args\":\"show\"}"));
+	EXPECT_EQ("bad value of \"args\"", problem("{\"args\":[\"show\",]}"));
+	EXPECT_EQ("bad value of \"args\"", problem("{\"args\":[1]}"));
+	EXPECT_EQ("bad value of \"line\"", problem("{\"line\":[\"show\"]}"));
+	EXPECT_EQ("bad value of \"id\"", problem("{\"id\":true,\"args\":[]}"));
+	EXPECT_EQ("bad value of \"id\"", problem("{\"id\":{},\"args\":[]}"));
+}
+
+TEST(RpcRequest, BadNumbers)
+{
+	const char* numbers[] = { "01", "-", "1.", ".5", "1e", "1e+", "+1", "0x10" };
+
+	for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i)
+		EXPECT_NE("", problem(std::string("{\"id\":") + numbers[i] + ",\"args\":[]}")) << numbers[i];
+}
+
+TEST(RpcRequest, Escapes)
+{
+	EXPECT_EQ("a\"\\/\b\f\n\r\tz", token("\"a\\\"\\\\\\/\\b\\f\\n\\r\\tz\""));
+	EXPECT_EQ("A\xc3\xa9\xe2\x82\xac", token("\"\\u0041\\u00e9\\u20AC\""));
+
+	// U+1F600 as a surrogate pair
+	EXPECT_EQ("\xf0\x9f\x98\x80", token("\"\\ud83d\\ude00\""));
+}
+
+TEST(RpcRequest, BadStrings)
+{
+	const char* strings[] = {
+		"\"unterminated",
+		"\"escape at the end\\",
+		"\"\\x\"",
+		"\"\\u00\"",
+		"\"\\u00g1\"",
+		"\"tab\tinside\"",
+		"\"new\nline\""
+	};
+
+	for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); ++i)
+		EXPECT_EQ("bad value of \"args\"", problem(std::string("{\"args\":[") + strings[i] + "]}")) << strings[i];
+}
+
+TEST(RpcRequest, LoneSurrogates)
+{
+	const char* strings[] = {
+		"\"\\ude00\"",
+		"\"\\ud83d\"",
+		"\"\\ud83dx\"",
+		// the escape after a high surrogate is no low one
+		"\"\\ud83d\\u0041\"",
+		"\"\\ud83d\\ud83d\\ude00\""
+	};
+
+	for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); ++i)
+		EXPECT_EQ("bad value of \"args\"", problem(std::string("{\"args\":[") + strings[i] + "]}")) << strings[i];
+}
+
+TEST(RpcResponse, StringsAreEscaped)
+{
+	std::string reply;
+	appendRpcResult(reply, "7", "a\"b\\c\n\x01");
+
+	EXPECT_EQ("{\"id\":7,\"ok\":true,\"output\":\"a\\\"b\\\\c\\n\\u0001\"}\n", reply);
+
+	reply.clear();
+	appendRpcBadRequest(reply, "null", "text after the request");
+
+	EXPECT_EQ("{\"id\":null,\"ok\":false,\"error\":{\"code\":\"bad_request\","
+			"\"description\":\"text after the request\"}}\n", reply);
+}
@@ -0,0 +1,70 @@
+/*
+ * cliTestCommand.h
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#ifndef CLITESTCOMMAND_H_
+#define CLITESTCOMMAND_H_
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "cliApi.h"
+#include "cliCommand.h"
+
+namespace CLI {
+
+	/* Words of a line, "" for an empty token */
+	inline BasicStringContainer_t words(const std::string& line)
+	{
+		std::istringstream input(line);
+		BasicStringContainer_t result;
+		std::string word;
+
+		while (input >> word)
+			result.push_back(word == "\"\"" ? std::string() : word);
+
+		return result;
+	}
+
+	/* Command made of fixed keywords only */
+	class KeywordCommand : public Command
+	{
+		public:
+			explicit KeywordCommand(const std::string& line) : keywords_(words(line)) {}
+
+			bool validate(const std::vector<std::string>& tokens, ParameterStorageType_t& , CommandError_t& cmdError)
+			{
+				if (tokens == keywords_)
+					return true;
+
+				cmdError.error = CLI_CMD_WRONG_KEYWORD;
+				cmdError.position = tokens.begin();
+				return false;
+			}
+
+			void getContextHelp(const std::vector<std::string>& tokens, std::vector<std::string>& help)
+			{
+				if (tokens.size() > keywords_.size() || !std::equal(tokens.begin(), tokens.end(), keywords_.begin()))
+					return;
+
+				help.push_back(tokens.size() < keywords_.size() ? keywords_[tokens.size()] + "  Keyword" : "<cr>");
+			}
+
+			char* completion(bool , const std::vector<std::string>& , int& )
+			{
+				return NULL;
+			}
+
+			void execute(const ParameterStorageType_t& , const std::string& ) {}
+
+		private:
+			BasicStringContainer_t keywords_;
+	};
+
+} // CLI
+
+#endif /* CLITESTCOMMAND_H_ */
@@ -0,0 +1,201 @@
+/*
+ * cliTokenizerTest.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: ast
+ */
+
+#include <gtest/gtest.h>
+
+#include "cliTokenizer.h"
+
+using namespace CLI;
+
+namespace {
+
+	const size_t LIMIT = 64;
+
+	BasicStringContainer_t split(Tokenizer& tokenizer, const std::string& line)
+	{
+		BasicStringContainer_t tokens;
+
+		tokenizer.split(line);
+		tokenizer.assign(tokens);
+
+		return tokens;
+	}
+
+	BasicStringContainer_t words(const char* first, const char* second = NULL, const char* third = NULL)
+	{
+		BasicStringContainer_t result(1, first);
+
+		if (second != NULL)
+			result.push_back(second);
+		if (third != NULL)
+			result.push_back(third);
+
+		return result;
+	}
+
+	/* Commands the line stands for */
+	std::vector<BasicStringContainer_t> expand(Tokenizer& tokenizer, const std::string& line)
+	{
+		std::vector<BasicStringContainer_t> lines;
+
+		BasicStringContainer_t tokens = split(tokenizer, line);
+		EXPECT_TRUE(tokenizer.expand(tokens, LIMIT, lines));
+
+		return lines;
+	}
+
+} // namespace
+
+TEST(Tokenizer, SplitsOnWhiteSpace)
+{
+	Tokenizer tokenizer;
+
+	EXPECT_EQ(words("show", "interface", "eth0"), split(tokenizer, " show\tinterface  eth0 \r\n"));
+	EXPECT_TRUE(split(tokenizer, " \t ").empty());
+}
+
+TEST(Tokenizer, SplitsLongLines)
+{
+	Tokenizer tokenizer;
+	std::string word(40, 'a');
+
+	// long enough to be scanned 16 bytes at a time
+	BasicStringContainer_t tokens = split(tokenizer, word + "\v" + word + "\f " + word);
+
+	ASSERT_EQ(3u, tokens.size());
+	EXPECT_EQ(word, tokens[2]);
+}
+
+TEST(Tokenizer, QuotedTokenIsTrimmed)
+{
+	Tokenizer tokenizer;
+
+	EXPECT_EQ(words("description", "link to core"), split(tokenizer, "description \"  link to core \""));
+	EXPECT_EQ(words("a", "", "b"), split(tokenizer, "a \"\" b"));
+}
+
+TEST(Tokenizer, CharacterAfterClosingQuoteSeparates)
+{
+	Tokenizer tokenizer;
+
+	EXPECT_EQ(words("a b", "c"), split(tokenizer, "\"a b\"xc"));
+}
+
+TEST(Tokenizer, UnterminatedQuoteTakesRestOfLine)
+{
+	Tokenizer tokenizer;
+
+	EXPECT_EQ(words("name", " rest of  line "), split(tokenizer, "name \" rest of  line "));
+}
+
+TEST(Tokenizer, PipeStartsFilters)
+{
+	Tokenizer tokenizer;
+	BasicStringContainer_t tokens, filter;
+
+	// the views point into the line
+	std::string line("show log | include error");
+
+	tokenizer.split(line);
+	tokenizer.assign(tokens, filter);
+
+	EXPECT_EQ(2u, tokenizer.pipe());
+	EXPECT_EQ(words("show", "log"), tokens);
+	EXPECT_EQ(words("|", "include", "error"), filter);
+
+	// a quoted pipe is a token like any other
+	line = "show \"|\" count";
+	tokenizer.split(line);
+	tokenizer.assign(tokens, filter);
+
+	EXPECT_EQ(3u, tokenizer.pipe());
+	EXPECT_TRUE(filter.empty());
+}
+
+TEST(Tokenizer, ExpandsNumberRanges)
+{
+	Tokenizer tokenizer;
+	std::vector<BasicStringContainer_t> lines = expand(tokenizer, "shutdown port {1,3-5}");
+
+	ASSERT_EQ(4u, lines.size());
+	EXPECT_EQ(words("shutdown", "port", "1"), lines[0]);
+	EXPECT_EQ(words("shutdown", "port", "5"), lines[3]);
+
+	lines = expand(tokenizer, "port {3-1}");
+
+	ASSERT_EQ(3u, lines.size());
+	EXPECT_EQ("3", lines[0][1]);
+	EXPECT_EQ("1", lines[2][1]);
+}
+
+TEST(Tokenizer, EarlierListVariesSlowest)
+{
+	Tokenizer tokenizer;
+	std::vector<BasicStringContainer_t> lines = expand(tokenizer, "counters {in,out} {1-2}");
+
+	ASSERT_EQ(4u, lines.size());
+	EXPECT_EQ(words("counters", "in", "1"), lines[0]);
+	EXPECT_EQ(words("counters", "in", "2"), lines[1]);
+	EXPECT_EQ(words("counters", "out", "1"), lines[2]);
+}
+
+TEST(Tokenizer, ListsWithinAWord)
+{
+	Tokenizer tokenizer;
+	std::vector<BasicStringContainer_t> lines = expand(tokenizer, "show eth{0-1}.{10,20}");
+
+	ASSERT_EQ(4u, lines.size());
+	EXPECT_EQ("eth0.10", lines[0][1]);
+	EXPECT_EQ("eth1.20", lines[3][1]);
+}
+
+TEST(Tokenizer, ListOfOneElementIsReplaced)
+{
+	Tokenizer tokenizer;
+	std::vector<BasicStringContainer_t> lines = expand(tokenizer, "port {7-7} {1,2}");
+
+	ASSERT_EQ(2u, lines.size());
+	EXPECT_EQ(words("port", "7", "1"), lines[0]);
+	EXPECT_EQ(words("port", "7", "2"), lines[1]);
+}
+
+TEST(Tokenizer, BracesWithoutListAreKept)
+{
+	Tokenizer tokenizer;
+	std::vector<BasicStringContainer_t> lines = expand(tokenizer, "match {abc} {} {1,}");
+
+	ASSERT_EQ(1u, lines.size());
+	EXPECT_EQ("{abc}", lines[0][1]);
+	EXPECT_EQ("{}", lines[0][2]);
+	EXPECT_EQ("{1,}", lines[0][3]);
+}
+
+TEST(Tokenizer, QuotedAndFilterTokensAreNotExpanded)
+{
+	Tokenizer tokenizer;
+
+	EXPECT_FALSE(split(tokenizer, "name \"{1-3}\"").empty());
+	EXPECT_FALSE(tokenizer.ranged());
+
+	split(tokenizer, "show log | include {1-3}");
+	EXPECT_FALSE(tokenizer.ranged());
+}
+
+TEST(Tokenizer, ExpansionOverLimitFails)
+{
+	Tokenizer tokenizer;
+	std::vector<BasicStringContainer_t> lines;
+
+	BasicStringContainer_t tokens = split(tokenizer, "port {1-10} {1-10}");
+
+	EXPECT_TRUE(tokenizer.expand(tokens, 100, lines));
+	EXPECT_EQ(100u, lines.size());
+	EXPECT_FALSE(tokenizer.expand(tokens, 99, lines));
+
+	tokens = split(tokenizer, "port {1-4294967295}");
+	EXPECT_FALSE(tokenizer.expand(tokens, LIMIT, lines));
+}